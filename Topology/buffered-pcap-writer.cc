@@ -0,0 +1,146 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include "buffered-pcap-writer.h"
+#include "profiling.h"
+#include "ns3/abort.h"
+#include "ns3/simulator.h"
+
+namespace ns3 {
+
+BufferedPcapWriter::BufferedPcapWriter (std::string fileName, uint32_t snapLen, bool headersOnly,
+                                        Time start, Time stop, const std::set<uint32_t> &addresses)
+  : m_snapLen (snapLen),
+    m_headersOnly (headersOnly),
+    m_start (start),
+    m_stop (stop),
+    m_addresses (addresses),
+    m_bytesWritten (0),
+    m_writeTime (0)
+{
+  m_file = fopen (fileName.c_str (), "wb");
+  NS_ABORT_MSG_UNLESS (m_file, "Cannot open " << fileName);
+  m_buffer.reserve (BLOCK_SIZE + HEADER_PEEK + 65536);
+
+  // Pcap global header, link type PPP
+  Put32 (0xa1b2c3d4);
+  Put16 (2);
+  Put16 (4);
+  Put32 (0);
+  Put32 (0);
+  Put32 (m_snapLen);
+  Put32 (9);
+}
+
+BufferedPcapWriter::~BufferedPcapWriter ()
+{
+  Flush ();
+  fclose (m_file);
+}
+
+void
+BufferedPcapWriter::Put32 (uint32_t value)
+{
+  const uint8_t *bytes = reinterpret_cast<const uint8_t *> (&value);
+  m_buffer.insert (m_buffer.end (), bytes, bytes + 4);
+}
+
+void
+BufferedPcapWriter::Put16 (uint16_t value)
+{
+  const uint8_t *bytes = reinterpret_cast<const uint8_t *> (&value);
+  m_buffer.insert (m_buffer.end (), bytes, bytes + 2);
+}
+
+void
+BufferedPcapWriter::Capture (Ptr<const Packet> packet)
+{
+  ProfileScope scope (PROFILE_PCAP);
+  Time now = Simulator::Now ();
+  if (now < m_start || now > m_stop)
+    {
+      return;
+    }
+
+  uint8_t peek[HEADER_PEEK];
+  uint32_t size = packet->GetSize ();
+  uint32_t peeked = packet->CopyData (peek, std::min<uint32_t> (size, HEADER_PEEK));
+
+  // PPP header (2 bytes) followed by the IPv4 header
+  bool isIpv4 = peeked >= 22 && peek[0] == 0x00 && peek[1] == 0x21;
+  if (!m_addresses.empty ())
+    {
+      if (!isIpv4)
+        {
+          return;
+        }
+      uint32_t src = (peek[14] << 24) | (peek[15] << 16) | (peek[16] << 8) | peek[17];
+      uint32_t dst = (peek[18] << 24) | (peek[19] << 16) | (peek[20] << 8) | peek[21];
+      if (m_addresses.count (src) == 0 && m_addresses.count (dst) == 0)
+        {
+          return;
+        }
+    }
+
+  uint32_t capLen = std::min (size, m_snapLen);
+  if (m_headersOnly && isIpv4)
+    {
+      uint32_t headers = 2 + (peek[2] & 0x0f) * 4;
+      if (peek[11] == 6 && peeked > headers + 12)
+        {
+          headers += (peek[headers + 12] >> 4) * 4;
+        }
+      capLen = std::min (capLen, headers);
+    }
+
+  Put32 (static_cast<uint32_t> (now.GetSeconds ()));
+  Put32 (static_cast<uint32_t> (now.GetMicroSeconds () % 1000000));
+  Put32 (capLen);
+  Put32 (size);
+  size_t offset = m_buffer.size ();
+  m_buffer.resize (offset + capLen);
+  packet->CopyData (&m_buffer[offset], capLen);
+
+  if (m_buffer.size () >= BLOCK_SIZE)
+    {
+      Flush ();
+    }
+}
+
+void
+BufferedPcapWriter::Flush (void)
+{
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+  fwrite (m_buffer.data (), 1, m_buffer.size (), m_file);
+  m_writeTime += std::chrono::steady_clock::now () - start;
+  m_bytesWritten += m_buffer.size ();
+  m_buffer.clear ();
+}
+
+uint64_t
+BufferedPcapWriter::GetBytesWritten (void) const
+{
+  return m_bytesWritten;
+}
+
+double
+BufferedPcapWriter::GetWriteSeconds (void) const
+{
+  return m_writeTime.count ();
+}
+
+} // namespace ns3
@@ -0,0 +1,73 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef BUFFERED_PCAP_WRITER_H
+#define BUFFERED_PCAP_WRITER_H
+
+#include <chrono>
+#include <cstdio>
+#include <set>
+#include <string>
+#include <vector>
+#include "ns3/nstime.h"
+#include "ns3/packet.h"
+#include "ns3/simple-ref-count.h"
+
+namespace ns3 {
+
+/**
+ * Pcap writer for the capture of one device. Records are appended to a
+ * preallocated buffer which is written to disk in large blocks, and can be
+ * limited to a time window, to the packets of some flows, to a snap length or
+ * to the PPP/IPv4/TCP headers.
+ */
+class BufferedPcapWriter : public SimpleRefCount<BufferedPcapWriter>
+{
+public:
+  BufferedPcapWriter (std::string fileName, uint32_t snapLen, bool headersOnly,
+                      Time start, Time stop, const std::set<uint32_t> &addresses);
+  ~BufferedPcapWriter ();
+
+  // Trace sink of the PromiscSniffer trace of a point to point device
+  void Capture (Ptr<const Packet> packet);
+
+  // Writes the buffered records to disk
+  void Flush (void);
+
+  uint64_t GetBytesWritten (void) const;
+  double GetWriteSeconds (void) const;
+
+private:
+  void Put32 (uint32_t value);
+  void Put16 (uint16_t value);
+
+  static const uint32_t BLOCK_SIZE = 1 << 20; // Size of the blocks written to disk
+  static const uint32_t HEADER_PEEK = 128;    // Bytes looked at to parse the headers
+
+  FILE *m_file;
+  std::vector<uint8_t> m_buffer;
+  uint32_t m_snapLen;
+  bool m_headersOnly;
+  Time m_start;
+  Time m_stop;
+  std::set<uint32_t> m_addresses;  // IPv4 addresses of the captured flows, empty for all
+  uint64_t m_bytesWritten;
+  std::chrono::duration<double> m_writeTime;
+};
+
+} // namespace ns3
+
+#endif /* BUFFERED_PCAP_WRITER_H */
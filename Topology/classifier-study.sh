@@ -0,0 +1,27 @@
+#!/bin/sh
+# Runs the dumbbell topology with TcpVeno and both loss classifiers (Diff
+# and RttDistribution) on lossy scenarios with and without delay jitter,
+# and prints the classification accuracy and goodput of every run. Run it
+# from the ns-3-dce directory; extra arguments are passed to every run,
+# e.g. ./classifier-study.sh --stopTime=60
+
+results=results/dumbbell-topology
+table=$results/classifier-study.txt
+echo "scenario jitter classifier accuracy goodput(Mbps)" > $table
+for scenario in iid gilbert
+do
+  for jitter in 0ms 5ms 20ms
+  do
+    for classifier in Diff RttDistribution
+    do
+      ./waf --run "dumbbelltopologyns3receiver --stack=ns3 --transport_prot=TcpVeno --pcap=false --scenario=$scenario --jitter=$jitter --classifier=$classifier $*" || exit 1
+      run=$(ls -td $results/*/ | head -1)
+      accuracy=$(awk '$1 == "classificationAccuracy" { print $2 }' $run/scenarioStats.txt)
+      goodput=$(awk '$1 == "goodput(Mbps)" { print $2 }' $run/scenarioStats.txt)
+      echo "$scenario $jitter $classifier $accuracy $goodput" >> $table
+      # Each run writes its results to a new timestamp directory
+      sleep 1
+    done
+  done
+done
+column -t $table
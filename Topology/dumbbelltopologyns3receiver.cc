@@ -22,6 +22,19 @@
 #include <iostream>
 #include <string>
 #include <fstream>
+#include <sstream>
+#include <map>
+#include <vector>
+#include <chrono>
+#include <set>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <cstring>
+#include <cstdio>
 #include "ns3/core-module.h"
 #include "ns3/network-module.h"
 #include "ns3/internet-module.h"
@@ -29,95 +42,1468 @@
 #include "ns3/applications-module.h"
 #include "ns3/traffic-control-module.h"
 #include "ns3/dce-module.h"
+#include "veno-samples.h"
+#include "gilbert-elliott-error-model.h"
+#include "jitter-queue-disc.h"
+#include "profiling.h"
+#include "queue-event-tracer.h"
+#include "hooked-tcp-socket-factory.h"
+#include "short-flow-application.h"
+#include "buffered-pcap-writer.h"
+#include "live-publisher.h"
+#include "run-config.h"
+#ifdef DCE_MPI
+#include "ns3/mpi-interface.h"
+#include <mpi.h>
+#endif
 
 using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("DumbbellTopology");
 Ptr<UniformRandomVariable> uv = CreateObject<UniformRandomVariable> ();
 std::string dir = "results/dumbbell-topology/";
+double startTime = 10;
 double stopTime = 20;
+uint64_t maxBytes = 0;
+
+// Opt-in stream of the TcpVeno samples of one flow, in the binary format of
+// veno-samples.h. Every sample, or one out of N, is written in blocks; a
+// reservoir keeps a uniform sample of bounded size, written at the end.
+class VenoSampleRecorder : public SimpleRefCount<VenoSampleRecorder>
+{
+public:
+  VenoSampleRecorder (std::string fileName, venosamples::Mode mode, uint32_t parameter, uint32_t beta);
+  ~VenoSampleRecorder ();
+
+  /**
+   * Assign a fixed random variable stream to the reservoir. The variable is
+   * only created here, with its stream, so that recording does not take an
+   * automatically assigned stream from the rest of the simulation.
+   *
+   * \param stream stream index to use
+   * \return the number of stream indices assigned
+   */
+  int64_t AssignStreams (int64_t stream);
+
+  // Trace sink of the Sample trace of TcpVeno
+  void Add (const TcpVeno::Sample &sample);
+
+  // Writes the buffered records and the final header
+  void Close (void);
+
+private:
+  static const uint32_t BUFFER_RECORDS = 1 << 12;
+
+  void Write (void);
+
+  FILE *m_file;
+  venosamples::FileHeader m_header;
+  std::vector<venosamples::Record> m_records;
+  Ptr<UniformRandomVariable> m_random;
+};
+
+/**
+ * RttMeanDeviation whose smoothed RTT and variation can be set, so that a
+ * warm-started sender does not begin with a fresh RTT estimate and the
+ * initial RTO.
+ */
+class CheckpointRttEstimator : public RttMeanDeviation
+{
+public:
+  static TypeId GetTypeId (void);
+
+  CheckpointRttEstimator ();
+  CheckpointRttEstimator (const CheckpointRttEstimator &r);
+
+  virtual Ptr<RttEstimator> Copy () const;
+
+  /**
+   * Restore the estimate of a checkpoint
+   *
+   * \param estimate smoothed RTT
+   * \param variation RTT variation
+   * \param nSamples number of samples the estimate was built from
+   */
+  void Restore (Time estimate, Time variation, uint32_t nSamples);
+};
+
+NS_OBJECT_ENSURE_REGISTERED (CheckpointRttEstimator);
+
+TypeId
+CheckpointRttEstimator::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::CheckpointRttEstimator")
+    .SetParent<RttMeanDeviation> ()
+    .AddConstructor<CheckpointRttEstimator> ()
+  ;
+  return tid;
+}
+
+CheckpointRttEstimator::CheckpointRttEstimator ()
+{
+}
+
+CheckpointRttEstimator::CheckpointRttEstimator (const CheckpointRttEstimator &r)
+  : RttMeanDeviation (r)
+{
+}
+
+Ptr<RttEstimator>
+CheckpointRttEstimator::Copy () const
+{
+  return CopyObject<CheckpointRttEstimator> (this);
+}
+
+void
+CheckpointRttEstimator::Restore (Time estimate, Time variation, uint32_t nSamples)
+{
+  m_estimatedRtt = estimate;
+  m_estimatedVariation = variation;
+  m_nSamples = nSamples;
+}
+
+/**
+ * Ground truth and sender decisions used to score loss classification.
+ * A reduction of ssthresh to about 4/5 of cwnd is Veno's "random loss"
+ * decision, a reduction to 1/2 is its "congestive loss" decision. Losses
+ * are attributed to the ns-3 flow of their source address; packets of the
+ * Linux flows only count in the totals. Also counts the ECN marks and the
+ * queueing delay of the bottleneck.
+ */
+class LossClassifier : public SimpleRefCount<LossClassifier>
+{
+public:
+  // flowByAddress maps the address of every ns-3 sender to its flow
+  LossClassifier (const std::map<uint32_t, uint32_t> &flowByAddress, uint32_t nFlows);
+
+  // Trace sink of the PhyRxDrop trace of the device carrying the error model
+  void ErrorModelDrop (Ptr<const Packet> p);
+
+  // Trace sinks of the Drop, Mark and SojournTime traces of the bottleneck queue disc
+  void QueueDiscDrop (Ptr<const QueueDiscItem> item);
+  void QueueDiscMark (Ptr<const QueueDiscItem> item, const char *reason);
+  void QueueDiscSojourn (Time sojourn);
+
+  // Scores a new ssthresh of a flow against the cwnd it was computed from
+  void SsThreshChanged (uint32_t flow, uint32_t lastCwnd, uint32_t newSsThresh);
+
+  void WriteLosses (std::ostream &os) const;
+  void WriteClassification (std::ostream &os) const;
+  void WriteQueueingDelay (std::ostream &os) const;
+
+  // Source of the live snapshots
+  void FillSnapshot (LiveSnapshot &snapshot) const;
+
+private:
+  // Counts a loss for the ns-3 flow sending from the source address
+  void CountFlowLoss (std::vector<uint32_t> &losses, Ipv4Address source);
+
+  std::map<uint32_t, uint32_t> m_flowByAddress;  // ns-3 sender address -> flow
+  std::vector<uint32_t> m_randomLosses;  // Per flow, packets lost on the error model since the last decision
+  std::vector<uint32_t> m_queueLosses;   // Per flow, packets dropped by the queue since the last decision
+  uint32_t m_decisions[2][2];       // [truth congestive][decided congestive]
+  uint64_t m_totalRandomLosses;
+  uint64_t m_totalQueueLosses;
+  uint64_t m_totalMarks;            // Packets CE-marked by the queue
+  double m_sojournSum;              // Sum of the queueing delays, in seconds
+  double m_sojournMax;
+  uint64_t m_sojournCount;
+};
+
+LossClassifier::LossClassifier (const std::map<uint32_t, uint32_t> &flowByAddress, uint32_t nFlows)
+  : m_flowByAddress (flowByAddress),
+    m_randomLosses (nFlows, 0),
+    m_queueLosses (nFlows, 0),
+    m_decisions (),
+    m_totalRandomLosses (0),
+    m_totalQueueLosses (0),
+    m_totalMarks (0),
+    m_sojournSum (0),
+    m_sojournMax (0),
+    m_sojournCount (0)
+{
+}
+
+void
+LossClassifier::CountFlowLoss (std::vector<uint32_t> &losses, Ipv4Address source)
+{
+  auto it = m_flowByAddress.find (source.Get ());
+  if (it != m_flowByAddress.end ())
+    {
+      losses [it->second]++;
+    }
+}
+
+// The packet still carries the PPP header of the receiving device
+void
+LossClassifier::ErrorModelDrop (Ptr<const Packet> p)
+{
+  ProfileScope scope (PROFILE_TRACES);
+  m_totalRandomLosses++;
+  Ptr<Packet> copy = p->Copy ();
+  PppHeader ppp;
+  copy->RemoveHeader (ppp);
+  if (ppp.GetProtocol () == 0x0021)
+    {
+      Ipv4Header ipv4;
+      copy->PeekHeader (ipv4);
+      CountFlowLoss (m_randomLosses, ipv4.GetSource ());
+    }
+}
+
+void
+LossClassifier::QueueDiscDrop (Ptr<const QueueDiscItem> item)
+{
+  ProfileScope scope (PROFILE_TRACES);
+  m_totalQueueLosses++;
+  Ptr<const Ipv4QueueDiscItem> ipv4Item = DynamicCast<const Ipv4QueueDiscItem> (item);
+  if (ipv4Item)
+    {
+      CountFlowLoss (m_queueLosses, ipv4Item->GetHeader ().GetSource ());
+    }
+}
+
+void
+LossClassifier::QueueDiscMark (Ptr<const QueueDiscItem> item, const char *reason)
+{
+  ProfileScope scope (PROFILE_TRACES);
+  m_totalMarks++;
+}
+
+void
+LossClassifier::QueueDiscSojourn (Time sojourn)
+{
+  ProfileScope scope (PROFILE_TRACES);
+  m_sojournSum += sojourn.GetSeconds ();
+  m_sojournMax = std::max (m_sojournMax, sojourn.GetSeconds ());
+  m_sojournCount++;
+}
+
+void
+LossClassifier::SsThreshChanged (uint32_t flow, uint32_t lastCwnd, uint32_t newSsThresh)
+{
+  // Only reductions below the current cwnd are loss responses; HyStart sets
+  // ssthresh to cwnd and the connection setup raises it.
+  if (newSsThresh >= 0.9 * lastCwnd)
+    {
+      return;
+    }
+  if (m_randomLosses [flow] + m_queueLosses [flow] == 0)
+    {
+      // Nothing of this flow was lost on the forward path, e.g. a spurious timeout
+      return;
+    }
+  bool truth = m_queueLosses [flow] > 0;
+  bool decided = newSsThresh < 0.65 * lastCwnd;
+  m_decisions[truth][decided]++;
+  m_randomLosses [flow] = 0;
+  m_queueLosses [flow] = 0;
+}
+
+void
+LossClassifier::WriteLosses (std::ostream &os) const
+{
+  os << "errorModelLosses " << m_totalRandomLosses << "\n";
+  os << "queueLosses " << m_totalQueueLosses << "\n";
+  os << "ecnMarks " << m_totalMarks << "\n";
+}
+
+void
+LossClassifier::WriteClassification (std::ostream &os) const
+{
+  const uint32_t (&d)[2][2] = m_decisions;
+  uint32_t total = d[0][0] + d[0][1] + d[1][0] + d[1][1];
+  os << "randomLossClassifiedRandom " << d[0][0] << "\n";
+  os << "randomLossClassifiedCongestive " << d[0][1] << "\n";
+  os << "congestiveLossClassifiedRandom " << d[1][0] << "\n";
+  os << "congestiveLossClassifiedCongestive " << d[1][1] << "\n";
+  os << "classificationAccuracy " << (total ? double (d[0][0] + d[1][1]) / total : 0.0) << "\n";
+}
+
+void
+LossClassifier::WriteQueueingDelay (std::ostream &os) const
+{
+  os << "meanQueueingDelay(ms) " << (m_sojournCount ? m_sojournSum / m_sojournCount * 1000 : 0.0) << "\n";
+  os << "maxQueueingDelay(ms) " << m_sojournMax * 1000 << "\n";
+}
+
+void
+LossClassifier::FillSnapshot (LiveSnapshot &snapshot) const
+{
+  snapshot.queueDrops = m_totalQueueLosses;
+  snapshot.errorDrops = m_totalRandomLosses;
+  snapshot.marks = m_totalMarks;
+  memcpy (snapshot.decisions, m_decisions, sizeof (m_decisions));
+}
+
+// Alternates the bottleneck between its nominal and a degraded capacity/delay,
+// in both directions
+static void
+VaryBottleneck (NetDeviceContainer devices, DataRate rate, Time delay,
+                DataRate degradedRate, Time degradedDelay, Time interval, bool degraded)
+{
+  for (uint32_t i = 0; i < devices.GetN (); i++)
+    {
+      devices.Get (i)->SetAttribute ("DataRate", DataRateValue (degraded ? degradedRate : rate));
+    }
+  devices.Get (0)->GetChannel ()->SetAttribute ("Delay", TimeValue (degraded ? degradedDelay : delay));
+  Simulator::Schedule (interval, &VaryBottleneck, devices, rate, delay,
+                       degradedRate, degradedDelay, interval, !degraded);
+}
+
+// Number of queue size samples per occupancy (in packets), for the
+// percentiles of the pacing/BQL study
+class QueueOccupancy : public SimpleRefCount<QueueOccupancy>
+{
+public:
+  // Samples taken before start are not counted
+  explicit QueueOccupancy (Time start);
+
+  void Add (uint32_t qSize);
+
+  // Returns the given percentile of the samples
+  uint32_t GetPercentile (double percentile) const;
+
+private:
+  Time m_start;
+  std::vector<uint64_t> m_counts;
+};
+
+QueueOccupancy::QueueOccupancy (Time start)
+  : m_start (start)
+{
+}
+
+void
+QueueOccupancy::Add (uint32_t qSize)
+{
+  if (Simulator::Now () < m_start)
+    {
+      return;
+    }
+  if (qSize >= m_counts.size ())
+    {
+      m_counts.resize (qSize + 1, 0);
+    }
+  m_counts [qSize]++;
+}
+
+uint32_t
+QueueOccupancy::GetPercentile (double percentile) const
+{
+  uint64_t total = 0;
+  for (uint64_t count : m_counts)
+    {
+      total += count;
+    }
+  uint64_t seen = 0;
+  for (uint32_t qSize = 0; qSize < m_counts.size (); qSize++)
+    {
+      seen += m_counts [qSize];
+      if (seen >= percentile / 100 * total)
+        {
+          return qSize;
+        }
+    }
+  return 0;
+}
 
 // Functions to check queue length of Router 1 for Linux and ns-3 stack
 void
-LinuxCheckQueueSize (Ptr<QueueDisc> queue)
+LinuxCheckQueueSize (Ptr<QueueDisc> queue, Ptr<QueueOccupancy> occupancy)
 {
+  ProfileScope scope (PROFILE_QUEUE_POLLING);
   uint32_t qSize = queue->GetCurrentSize ().GetValue ();
+  occupancy->Add (qSize);
 
   // Check queue size in Linux stack every 1/100 of a second
-  Simulator::Schedule (Seconds (0.001), &LinuxCheckQueueSize, queue);
+  Simulator::Schedule (Seconds (0.001), &LinuxCheckQueueSize, queue, occupancy);
   std::ofstream fPlotQueue (std::stringstream (dir + "linux-queue-size.plotme").str ().c_str (), std::ios::out | std::ios::app);
   fPlotQueue << Simulator::Now ().GetSeconds () << " " << qSize << std::endl;
   fPlotQueue.close ();
 }
 
 void
-ns3CheckQueueSize (Ptr<QueueDisc> queue)
+ns3CheckQueueSize (Ptr<QueueDisc> queue, Ptr<QueueOccupancy> occupancy)
 {
+  ProfileScope scope (PROFILE_QUEUE_POLLING);
   uint32_t qSize = queue->GetCurrentSize ().GetValue ();
+  occupancy->Add (qSize);
 
   // Check queue size in ns-3 stack every 1/100 of a second
-  Simulator::Schedule (Seconds (0.001), &ns3CheckQueueSize, queue);
+  Simulator::Schedule (Seconds (0.001), &ns3CheckQueueSize, queue, occupancy);
   std::ofstream fPlotQueue (std::stringstream (dir + "ns3-queue-size.plotme").str ().c_str (), std::ios::out | std::ios::app);
   fPlotQueue << Simulator::Now ().GetSeconds () << " " << qSize << std::endl;
   fPlotQueue.close ();
 }
 
-// Functions to trace change in cwnd for all the senders
+// Name of the flow sent by a sender node, as parse_cwnd.py names them:
+// node 2 is A, node 3 is B, ... and nodes past Z keep their id
+std::string
+FlowName (Ptr<Node> node)
+{
+  if (node->GetId () + 63 <= 'Z')
+    {
+      return std::string (1, static_cast<char> (node->GetId () + 63));
+    }
+  return "N" + std::to_string (node->GetId ());
+}
+
+// Returns true if the node is simulated by this process; always true
+// unless the scenario is distributed over MPI ranks
+bool
+IsLocal (Ptr<Node> node)
+{
+#ifdef DCE_MPI
+  if (MpiInterface::IsEnabled ())
+    {
+      return node->GetSystemId () == MpiInterface::GetSystemId ();
+    }
+#endif
+  return true;
+}
+
+VenoSampleRecorder::VenoSampleRecorder (std::string fileName, venosamples::Mode mode, uint32_t parameter, uint32_t beta)
+{
+  m_file = fopen (fileName.c_str (), "wb");
+  NS_ABORT_MSG_UNLESS (m_file, "Cannot create " << fileName);
+  memset (&m_header, 0, sizeof (m_header));
+  memcpy (m_header.magic, venosamples::MAGIC, sizeof (m_header.magic));
+  m_header.recordSize = sizeof (venosamples::Record);
+  m_header.mode = mode;
+  m_header.parameter = parameter;
+  m_header.beta = beta;
+  // Rewritten by Close once the counts are known
+  fwrite (&m_header, sizeof (m_header), 1, m_file);
+  m_records.reserve ((mode == venosamples::MODE_RESERVOIR) ? parameter : BUFFER_RECORDS);
+}
+
+VenoSampleRecorder::~VenoSampleRecorder ()
+{
+  Close ();
+}
+
+int64_t
+VenoSampleRecorder::AssignStreams (int64_t stream)
+{
+  m_random = CreateObjectWithAttributes<UniformRandomVariable> ("Stream", IntegerValue (stream));
+  return 1;
+}
+
+void
+VenoSampleRecorder::Add (const TcpVeno::Sample &sample)
+{
+  ProfileScope scope (PROFILE_TRACES);
+  uint64_t offered = m_header.offered++;
+  venosamples::Record *record = 0;
+  if (m_header.mode == venosamples::MODE_RESERVOIR)
+    {
+      // Algorithm R: the n-th sample replaces a random record with
+      // probability parameter / n
+      if (m_records.size () < m_header.parameter)
+        {
+          m_records.push_back (venosamples::Record ());
+          record = &m_records.back ();
+        }
+      else
+        {
+          NS_ABORT_MSG_UNLESS (m_random, "VenoSampleRecorder reservoir without a stream");
+          uint64_t slot = static_cast<uint64_t> (m_random->GetValue (0, offered + 1));
+          record = (slot < m_header.parameter) ? &m_records [slot] : 0;
+        }
+    }
+  else if (offered % m_header.parameter == 0)
+    {
+      m_records.push_back (venosamples::Record ());
+      record = &m_records.back ();
+    }
+  if (!record)
+    {
+      return;
+    }
+
+  const uint64_t maxUs = venosamples::NO_RTT;
+  record->time = Simulator::Now ().GetSeconds ();
+  record->rttUs = std::min<uint64_t> (sample.rtt.GetMicroSeconds (), maxUs);
+  record->baseRttUs = std::min<uint64_t> (sample.baseRtt.GetMicroSeconds (), maxUs);
+  record->minRttUs = std::min<uint64_t> (sample.minRtt.GetMicroSeconds (), maxUs);
+  record->segCwnd = sample.segCwnd;
+  record->targetCwnd = sample.targetCwnd;
+  record->diff = std::min<uint32_t> (sample.diff, UINT16_MAX);
+  record->decision = sample.decision;
+  record->reserved = 0;
+
+  if (m_header.mode != venosamples::MODE_RESERVOIR && m_records.size () == BUFFER_RECORDS)
+    {
+      Write ();
+    }
+}
+
+void
+VenoSampleRecorder::Write (void)
+{
+  fwrite (m_records.data (), sizeof (venosamples::Record), m_records.size (), m_file);
+  m_header.records += m_records.size ();
+  m_records.clear ();
+}
+
+void
+VenoSampleRecorder::Close (void)
+{
+  if (!m_file)
+    {
+      return;
+    }
+  if (m_header.mode == venosamples::MODE_RESERVOIR)
+    {
+      std::sort (m_records.begin (), m_records.end (),
+                 [] (const venosamples::Record &a, const venosamples::Record &b) { return a.time < b.time; });
+    }
+  Write ();
+  fseek (m_file, 0, SEEK_SET);
+  fwrite (&m_header, sizeof (m_header), 1, m_file);
+  fclose (m_file);
+  m_file = 0;
+}
+
+/**
+ * Records the flow completion time of the finite transfer of every flow,
+ * when the sink has received maxBytes from its sender
+ */
+class FctRecorder : public SimpleRefCount<FctRecorder>
+{
+public:
+  FctRecorder (Ptr<OutputStreamWrapper> stream, const std::map<uint32_t, uint32_t> &flowByAddress,
+               const std::vector<std::string> &flowNames, uint64_t maxBytes, Time start);
+
+  // Trace sink of the Rx trace of the sink application
+  void Rx (Ptr<const Packet> packet, const Address &from);
+
+private:
+  Ptr<OutputStreamWrapper> m_stream;
+  std::map<uint32_t, uint32_t> m_flowByAddress;   // Sender address -> flow
+  std::vector<std::string> m_flowNames;
+  std::vector<uint64_t> m_rxBytes;                // Bytes received per flow
+  uint64_t m_maxBytes;
+  Time m_start;
+};
+
+FctRecorder::FctRecorder (Ptr<OutputStreamWrapper> stream, const std::map<uint32_t, uint32_t> &flowByAddress,
+                          const std::vector<std::string> &flowNames, uint64_t maxBytes, Time start)
+  : m_stream (stream),
+    m_flowByAddress (flowByAddress),
+    m_flowNames (flowNames),
+    m_rxBytes (flowNames.size (), 0),
+    m_maxBytes (maxBytes),
+    m_start (start)
+{
+}
+
+void
+FctRecorder::Rx (Ptr<const Packet> packet, const Address &from)
+{
+  ProfileScope scope (PROFILE_TRACES);
+  auto it = m_flowByAddress.find (InetSocketAddress::ConvertFrom (from).GetIpv4 ().Get ());
+  if (it == m_flowByAddress.end ())
+    {
+      return;
+    }
+  uint64_t &rxBytes = m_rxBytes [it->second];
+  if (rxBytes < m_maxBytes && rxBytes + packet->GetSize () >= m_maxBytes)
+    {
+      *m_stream->GetStream () << "fct " << m_flowNames [it->second] << " "
+                              << (Simulator::Now () - m_start).GetSeconds () << " bytes " << m_maxBytes << std::endl;
+    }
+  rxBytes += packet->GetSize ();
+}
+
+// Goodput of every flow at the sink, used by the fairness benchmark and the
+// live metrics
+class FairnessMonitor : public SimpleRefCount<FairnessMonitor>
+{
+public:
+  FairnessMonitor (const std::map<uint32_t, uint32_t> &flowByAddress, uint32_t nFlows);
+
+  // Trace sink of the Rx trace of the sink application
+  void Rx (Ptr<const Packet> packet, const Address &from);
+
+  // Writes the fairness index, the goodput shares and the bottleneck
+  // utilization over a sliding window of stepsPerWindow steps, once per
+  // step, from the first Sample on
+  void SetWindows (Ptr<OutputStreamWrapper> stream, Time step, uint32_t stepsPerWindow, double capacity);
+  void Sample (void);
+
+  uint64_t GetRxBytes (uint32_t flow) const;
+
+  // Writes the mean and minimum index and the mean utilization of the windows
+  void WriteWindowStats (std::ostream &os) const;
+
+  // Source of the live snapshots
+  void FillSnapshot (LiveSnapshot &snapshot) const;
+
+private:
+  std::map<uint32_t, uint32_t> m_flowByAddress;   // Sender address -> flow
+  std::vector<uint64_t> m_rxBytes;                // Bytes received per flow
+  std::deque<std::vector<uint64_t> > m_history;   // m_rxBytes at the steps of the current window
+  Ptr<OutputStreamWrapper> m_stream;
+  Time m_step;
+  uint32_t m_stepsPerWindow;
+  double m_capacity;
+  double m_jainSum;
+  double m_jainMin;
+  double m_utilizationSum;
+  uint32_t m_windows;
+};
+
+FairnessMonitor::FairnessMonitor (const std::map<uint32_t, uint32_t> &flowByAddress, uint32_t nFlows)
+  : m_flowByAddress (flowByAddress),
+    m_rxBytes (nFlows, 0),
+    m_stepsPerWindow (1),
+    m_capacity (0),
+    m_jainSum (0),
+    m_jainMin (1),
+    m_utilizationSum (0),
+    m_windows (0)
+{
+}
+
+void
+FairnessMonitor::Rx (Ptr<const Packet> packet, const Address &from)
+{
+  ProfileScope scope (PROFILE_TRACES);
+  auto it = m_flowByAddress.find (InetSocketAddress::ConvertFrom (from).GetIpv4 ().Get ());
+  if (it != m_flowByAddress.end ())
+    {
+      m_rxBytes [it->second] += packet->GetSize ();
+    }
+}
+
+// Jain's fairness index of the given throughputs
+double
+JainIndex (const std::vector<double> &throughputs)
+{
+  double sum = 0;
+  double sumSquares = 0;
+  for (double x : throughputs)
+    {
+      sum += x;
+      sumSquares += x * x;
+    }
+  return sumSquares > 0 ? sum * sum / (throughputs.size () * sumSquares) : 1.0;
+}
+
+void
+FairnessMonitor::SetWindows (Ptr<OutputStreamWrapper> stream, Time step, uint32_t stepsPerWindow, double capacity)
+{
+  m_stream = stream;
+  m_step = step;
+  m_stepsPerWindow = stepsPerWindow;
+  m_capacity = capacity;
+  *m_stream->GetStream () << "# time jainIndex utilization share per flow" << std::endl;
+}
+
+void
+FairnessMonitor::Sample (void)
+{
+  m_history.push_back (m_rxBytes);
+  if (m_history.size () > m_stepsPerWindow + 1)
+    {
+      m_history.pop_front ();
+    }
+  if (m_history.size () == m_stepsPerWindow + 1)
+    {
+      double window = m_step.GetSeconds () * m_stepsPerWindow;
+      std::vector<double> goodputs;
+      double total = 0;
+      for (uint32_t flow = 0; flow < m_rxBytes.size (); flow++)
+        {
+          goodputs.push_back ((m_history.back () [flow] - m_history.front () [flow]) * 8.0 / window);
+          total += goodputs.back ();
+        }
+      double jain = JainIndex (goodputs);
+      m_jainSum += jain;
+      m_jainMin = std::min (m_jainMin, jain);
+      m_utilizationSum += total / m_capacity;
+      m_windows++;
+      *m_stream->GetStream () << Simulator::Now ().GetSeconds () << " " << jain << " " << total / m_capacity;
+      for (double goodput : goodputs)
+        {
+          *m_stream->GetStream () << " " << (total > 0 ? goodput / total : 0.0);
+        }
+      *m_stream->GetStream () << std::endl;
+    }
+  Simulator::Schedule (m_step, &FairnessMonitor::Sample, Ptr<FairnessMonitor> (this));
+}
+
+uint64_t
+FairnessMonitor::GetRxBytes (uint32_t flow) const
+{
+  return m_rxBytes [flow];
+}
+
+void
+FairnessMonitor::WriteWindowStats (std::ostream &os) const
+{
+  os << "meanWindowJainIndex " << (m_windows ? m_jainSum / m_windows : 0.0) << "\n";
+  os << "minWindowJainIndex " << (m_windows ? m_jainMin : 0.0) << "\n";
+  os << "meanWindowUtilization " << (m_windows ? m_utilizationSum / m_windows : 0.0) << "\n";
+}
+
+void
+FairnessMonitor::FillSnapshot (LiveSnapshot &snapshot) const
+{
+  snapshot.rxBytes = m_rxBytes;
+}
+
+// Functions to trace change in cwnd (or ssthresh) for all the senders, in segments
 static void
-CwndChangeA (uint32_t oldCwnd, uint32_t newCwnd)
+CwndChange (Ptr<OutputStreamWrapper> stream, double segmentSize, uint32_t oldCwnd, uint32_t newCwnd)
 {
-  std::ofstream fPlotQueue (dir + "cwndTraces/A-ns3.plotme", std::ios::out | std::ios::app);
-  fPlotQueue << Simulator::Now ().GetSeconds () << " " << newCwnd / 524.0 << std::endl;
-  fPlotQueue.close ();
+  ProfileScope scope (PROFILE_TRACES);
+  *stream->GetStream () << Simulator::Now ().GetSeconds () << " " << newCwnd / segmentSize << "\n";
+}
+
+/**
+ * Congestion control state of one ns-3 sender, across the sockets it opens.
+ * Gives every socket its own congestion control object, restored from a
+ * checkpoint if one was loaded, traces cwnd and ssthresh, counts the
+ * retransmissions, scores the loss classification and records the TcpVeno
+ * samples. The state is used to write checkpoints.
+ */
+class Sender : public SimpleRefCount<Sender>
+{
+public:
+  Sender (uint32_t flow, ObjectFactory congestionFactory);
+
+  // Traces cwnd and ssthresh, in segments, to the given streams
+  void SetTraceStreams (Ptr<OutputStreamWrapper> cwndStream, Ptr<OutputStreamWrapper> ssThreshStream);
+
+  // Scores the ssthresh reductions of the sender with the classifier
+  void SetLossClassifier (Ptr<LossClassifier> classifier);
+
+  // Gives the sockets an RTT estimator that can be checkpointed
+  void EnableCheckpoints (void);
+
+  // Warm-starts the sockets from the checkpoint line of the flow
+  void SetRestoredState (std::string state);
+
+  // Records the TcpVeno samples to fileName, venoSamples/<flow>-ns3.bin
+  void RecordVenoSamples (std::string fileName, venosamples::Mode mode, uint32_t parameter, int64_t stream);
+
+  uint32_t GetFlow (void) const;
+
+  // Returns a new congestion control object of the protocol of the sender
+  Ptr<TcpCongestionOps> CreateCongestionOps (void) const;
+
+  // Trace sink of the SocketCreated trace of the HookedTcpSocketFactory of the sender
+  void SocketCreated (Ptr<Socket> socket);
+
+  // Counts the data segments a socket of the flow sends below the highest
+  // sequence number it sent so far
+  void CountTx (SequenceNumber32 &highTxSeq, Ptr<const Packet> packet, const TcpHeader &header);
+
+  uint64_t GetRetransmissions (void) const;
+
+  // Writes the checkpoint line of the sender, nothing before its first socket
+  void WriteCheckpoint (std::ostream &os, uint32_t segmentSize) const;
+
+  // Source of the live snapshots
+  void FillSnapshot (LiveSnapshot &snapshot) const;
+
+  // Writes the buffered TcpVeno samples
+  void Close (void);
+
+private:
+  void CwndChanged (uint32_t oldCwnd, uint32_t newCwnd);
+  void SsThreshChanged (uint32_t oldSsThresh, uint32_t newSsThresh);
+  void Tx (Ptr<const Packet> packet, const TcpHeader &header, Ptr<const TcpSocketBase> socket);
+
+  uint32_t m_flow;
+  ObjectFactory m_congestionFactory;  // Congestion control of the flow
+  Ptr<TcpCongestionOps> m_congestionOps;
+  bool m_checkpoints;
+  std::string m_restoredState;      // Checkpoint line of the flow, empty if not restored
+  Ptr<CheckpointRttEstimator> m_rtt; // RTT estimator, with checkpoints only
+  uint32_t m_cWnd;
+  uint32_t m_ssThresh;
+  uint64_t m_retransmissions;       // Data segments sent again by the sender
+  SequenceNumber32 m_highTxSeq;     // Highest sequence number sent so far
+  Ptr<LossClassifier> m_classifier;
+  Ptr<OutputStreamWrapper> m_cwndStream; // cwndTraces/<flow>-ns3.plotme
+  Ptr<OutputStreamWrapper> m_ssThreshStream; // cwndTraces/<flow>-ns3-ssthresh.plotme
+  std::string m_venoSampleFile;     // Empty if not recorded
+  venosamples::Mode m_venoSampleMode;
+  uint32_t m_venoSampleParameter;
+  int64_t m_venoSampleStream;       // Random stream of the sample reservoir
+  Ptr<VenoSampleRecorder> m_venoSamples;
+};
+
+Sender::Sender (uint32_t flow, ObjectFactory congestionFactory)
+  : m_flow (flow),
+    m_congestionFactory (congestionFactory),
+    m_checkpoints (false),
+    m_cWnd (0),
+    m_ssThresh (0),
+    m_retransmissions (0),
+    m_venoSampleMode (venosamples::MODE_ALL),
+    m_venoSampleParameter (1),
+    m_venoSampleStream (0)
+{
+}
+
+void
+Sender::SetTraceStreams (Ptr<OutputStreamWrapper> cwndStream, Ptr<OutputStreamWrapper> ssThreshStream)
+{
+  m_cwndStream = cwndStream;
+  m_ssThreshStream = ssThreshStream;
+}
+
+void
+Sender::SetLossClassifier (Ptr<LossClassifier> classifier)
+{
+  m_classifier = classifier;
+}
+
+void
+Sender::EnableCheckpoints (void)
+{
+  m_checkpoints = true;
+}
+
+void
+Sender::SetRestoredState (std::string state)
+{
+  NS_ABORT_MSG_UNLESS (m_checkpoints, "Flow " << m_flow << " is restored without checkpoints");
+  m_restoredState = state;
+}
+
+void
+Sender::RecordVenoSamples (std::string fileName, venosamples::Mode mode, uint32_t parameter, int64_t stream)
+{
+  m_venoSampleFile = fileName;
+  m_venoSampleMode = mode;
+  m_venoSampleParameter = parameter;
+  m_venoSampleStream = stream;
+}
+
+uint32_t
+Sender::GetFlow (void) const
+{
+  return m_flow;
+}
+
+Ptr<TcpCongestionOps>
+Sender::CreateCongestionOps (void) const
+{
+  return m_congestionFactory.Create<TcpCongestionOps> ();
+}
+
+void
+Sender::SocketCreated (Ptr<Socket> socket)
+{
+  Ptr<TcpSocketBase> tcpSocket = DynamicCast<TcpSocketBase> (socket);
+  NS_ABORT_MSG_UNLESS (tcpSocket, "Sender socket is not an ns-3 TCP socket");
+
+  m_congestionOps = CreateCongestionOps ();
+  // A new connection starts again from sequence number 0
+  m_highTxSeq = SequenceNumber32 (0);
+  m_cWnd = 0;
+  m_ssThresh = 0;
+  if (m_checkpoints)
+    {
+      m_rtt = CreateObject<CheckpointRttEstimator> ();
+      tcpSocket->SetRtt (m_rtt);
+    }
+
+  if (!m_restoredState.empty ())
+    {
+      std::istringstream is (m_restoredState);
+      std::string name;
+      uint32_t segmentSize, cWnd, ssThresh, rttSamples;
+      int64_t srtt, rttVar;
+      is >> name >> segmentSize >> cWnd >> ssThresh >> srtt >> rttVar >> rttSamples;
+      NS_ABORT_MSG_IF (is.fail (), "Malformed checkpoint of flow " << m_flow);
+      NS_ABORT_MSG_UNLESS (name == m_congestionOps->GetName (),
+                           "Checkpoint of flow " << m_flow << " was taken with " << name);
+      socket->SetAttribute ("SegmentSize", UintegerValue (segmentSize));
+      socket->SetAttribute ("InitialCwnd", UintegerValue (std::max<uint32_t> (1, cWnd / segmentSize)));
+      socket->SetAttribute ("InitialSlowStartThreshold", UintegerValue (ssThresh));
+      if (rttSamples > 0)
+        {
+          m_rtt->Restore (Time (srtt), Time (rttVar), rttSamples);
+        }
+      m_congestionOps->DeserializeState (is);
+    }
+  tcpSocket->SetCongestionControlAlgorithm (ProfiledCongestionOps::Wrap (m_congestionOps));
+
+  // Only TcpVeno reports its samples
+  Ptr<TcpVeno> veno = DynamicCast<TcpVeno> (m_congestionOps);
+  if (veno && !m_venoSampleFile.empty ())
+    {
+      if (!m_venoSamples)
+        {
+          UintegerValue beta;
+          veno->GetAttribute ("Beta", beta);
+          m_venoSamples = Create<VenoSampleRecorder> (m_venoSampleFile, m_venoSampleMode,
+                                                      m_venoSampleParameter, beta.Get ());
+          m_venoSamples->AssignStreams (m_venoSampleStream);
+        }
+      veno->TraceConnectWithoutContext ("Sample", MakeCallback (&VenoSampleRecorder::Add, m_venoSamples));
+    }
+
+  socket->TraceConnectWithoutContext ("CongestionWindow", MakeCallback (&Sender::CwndChanged, this));
+  if (m_cwndStream)
+    {
+      UintegerValue segmentSize;
+      socket->GetAttribute ("SegmentSize", segmentSize);
+      socket->TraceConnectWithoutContext ("CongestionWindow", MakeBoundCallback (&CwndChange, m_cwndStream,
+                                                                                  static_cast<double> (segmentSize.Get ())));
+      socket->TraceConnectWithoutContext ("SlowStartThreshold", MakeBoundCallback (&CwndChange, m_ssThreshStream,
+                                                                                    static_cast<double> (segmentSize.Get ())));
+    }
+  socket->TraceConnectWithoutContext ("SlowStartThreshold", MakeCallback (&Sender::SsThreshChanged, this));
+  socket->TraceConnectWithoutContext ("Tx", MakeCallback (&Sender::Tx, this));
+}
+
+void
+Sender::CwndChanged (uint32_t oldCwnd, uint32_t newCwnd)
+{
+  ProfileScope scope (PROFILE_TRACES);
+  m_cWnd = newCwnd;
+}
+
+// Called before the new ssthresh is stored, m_cWnd is still the cwnd the
+// reduction was computed from
+void
+Sender::SsThreshChanged (uint32_t oldSsThresh, uint32_t newSsThresh)
+{
+  ProfileScope scope (PROFILE_TRACES);
+  if (m_classifier)
+    {
+      m_classifier->SsThreshChanged (m_flow, m_cWnd, newSsThresh);
+    }
+  m_ssThresh = newSsThresh;
+}
+
+void
+Sender::Tx (Ptr<const Packet> packet, const TcpHeader &header, Ptr<const TcpSocketBase> socket)
+{
+  ProfileScope scope (PROFILE_TRACES);
+  CountTx (m_highTxSeq, packet, header);
+}
+
+void
+Sender::CountTx (SequenceNumber32 &highTxSeq, Ptr<const Packet> packet, const TcpHeader &header)
+{
+  if (packet->GetSize () == 0)
+    {
+      return;
+    }
+  if (header.GetSequenceNumber () < highTxSeq)
+    {
+      m_retransmissions++;
+    }
+  else
+    {
+      highTxSeq = header.GetSequenceNumber () + packet->GetSize ();
+    }
+}
+
+uint64_t
+Sender::GetRetransmissions (void) const
+{
+  return m_retransmissions;
+}
+
+void
+Sender::WriteCheckpoint (std::ostream &os, uint32_t segmentSize) const
+{
+  if (!m_congestionOps)
+    {
+      return;
+    }
+  os << "flow " << m_flow << " " << m_congestionOps->GetName () << " " << segmentSize
+     << " " << m_cWnd << " " << m_ssThresh << " "
+     << m_rtt->GetEstimate ().GetTimeStep () << " " << m_rtt->GetVariation ().GetTimeStep () << " "
+     << m_rtt->GetNSamples () << " ";
+  m_congestionOps->SerializeState (os);
+  os << "\n";
+}
+
+void
+Sender::FillSnapshot (LiveSnapshot &snapshot) const
+{
+  if (m_congestionOps)
+    {
+      snapshot.cwnd [m_flow] = m_cWnd;
+    }
+}
+
+void
+Sender::Close (void)
+{
+  if (m_venoSamples)
+    {
+      m_venoSamples->Close ();
+    }
+}
+
+// Returns the given percentile of sorted values
+double
+Percentile (const std::vector<double> &sorted, double percentile)
+{
+  if (sorted.empty ())
+    {
+      return 0;
+    }
+  size_t rank = static_cast<size_t> (std::ceil (percentile / 100 * sorted.size ()));
+  return sorted [std::min (sorted.size (), std::max<size_t> (rank, 1)) - 1];
+}
+
+// Short flows of the FCT benchmark, with the time they completed, failed
+// or were cut by the end of the run
+class FlowCompletionLog : public SimpleRefCount<FlowCompletionLog>
+{
+public:
+  enum Outcome
+  {
+    COMPLETED,
+    FAILED,
+    CENSORED
+  };
+
+  void Add (uint32_t sender, Outcome outcome, uint64_t size, Time fct);
+
+  // Writes the FCT percentiles of the completed short flows per protocol and size bucket
+  void WriteStats (std::string fileName, const std::vector<std::string> &flowProtocols) const;
+
+private:
+  struct FlowCompletion
+  {
+    uint64_t size;
+    double fct;
+    uint32_t sender;
+    Outcome outcome;
+  };
+
+  std::vector<FlowCompletion> m_flows;
+};
+
+void
+FlowCompletionLog::Add (uint32_t sender, Outcome outcome, uint64_t size, Time fct)
+{
+  FlowCompletion completion;
+  completion.size = size;
+  completion.fct = fct.GetSeconds ();
+  completion.sender = sender;
+  completion.outcome = outcome;
+  m_flows.push_back (completion);
+}
+
+void
+FlowCompletionLog::WriteStats (std::string fileName, const std::vector<std::string> &flowProtocols) const
+{
+  static const uint64_t bucketLimits[] = {10000, 100000, 1000000, std::numeric_limits<uint64_t>::max ()};
+  static const char *bucketNames[] = {"(0,10KB]", "(10KB,100KB]", "(100KB,1MB]", "(1MB,inf)"};
+  struct Bucket
+  {
+    std::vector<double> fcts;           // Completed flows
+    uint32_t failed = 0;
+    uint32_t censored = 0;
+  };
+  std::map<std::pair<std::string, uint32_t>, Bucket> buckets;
+  for (const FlowCompletion &completion : m_flows)
+    {
+      uint32_t bucket = 0;
+      while (completion.size > bucketLimits [bucket])
+        {
+          bucket++;
+        }
+      Bucket &entry = buckets [std::make_pair (flowProtocols [completion.sender], bucket)];
+      if (completion.outcome == COMPLETED)
+        {
+          entry.fcts.push_back (completion.fct);
+        }
+      else if (completion.outcome == FAILED)
+        {
+          entry.failed++;
+        }
+      else
+        {
+          entry.censored++;
+        }
+    }
+  std::ofstream os (fileName.c_str (), std::ios::out | std::ios::trunc);
+  os << "# protocol bucket flows mean(ms) p50(ms) p99(ms) p99.9(ms) failed censored\n";
+  for (auto &entry : buckets)
+    {
+      std::vector<double> &values = entry.second.fcts;
+      std::sort (values.begin (), values.end ());
+      double sum = 0;
+      for (double value : values)
+        {
+          sum += value;
+        }
+      os << entry.first.first << " " << bucketNames [entry.first.second] << " " << values.size () << " "
+         << (values.empty () ? 0.0 : sum / values.size () * 1000) << " " << Percentile (values, 50) * 1000 << " "
+         << Percentile (values, 99) * 1000 << " " << Percentile (values, 99.9) * 1000 << " "
+         << entry.second.failed << " " << entry.second.censored << "\n";
+    }
+  os.close ();
+}
+
+// Highest sequence number sent by one short flow socket
+struct ShortFlowTxState : public SimpleRefCount<ShortFlowTxState>
+{
+  Ptr<Sender> sender;
+  SequenceNumber32 highTxSeq;
+};
+
+static void
+ShortFlowTx (Ptr<ShortFlowTxState> state, Ptr<const Packet> packet, const TcpHeader &header, Ptr<const TcpSocketBase> socket)
+{
+  ProfileScope scope (PROFILE_TRACES);
+  state->sender->CountTx (state->highTxSeq, packet, header);
+}
+
+/**
+ * Gives the short flow sockets of a sender the congestion control of the
+ * sender, counts their retransmissions in the sender and logs the outcome
+ * of their flows. The sockets of a sender overlap, so their cwnd is not
+ * traced and their ssthresh is not scored by the loss classifier. The
+ * state kept for a socket is dropped as soon as its flow ends, while the
+ * socket may still linger in TIME_WAIT.
+ */
+class ShortFlowTracer : public SimpleRefCount<ShortFlowTracer>
+{
+public:
+  ShortFlowTracer (Ptr<Sender> sender, Ptr<FlowCompletionLog> log);
+
+  // Trace sinks of the SocketCreated and FlowEnded traces of a ShortFlowApplication
+  void SocketCreated (Ptr<Socket> socket);
+  void FlowEnded (Ptr<Socket> socket);
+
+  // Trace sinks of the FlowCompleted, FlowFailed and FlowCensored traces
+  void FlowCompleted (uint64_t size, Time fct);
+  void FlowFailed (uint64_t size, Time fct);
+  void FlowCensored (uint64_t size, Time fct);
+
+  // Returns the number of sockets whose state is held
+  size_t GetOpenFlows () const;
+
+private:
+  Ptr<Sender> m_sender;
+  Ptr<FlowCompletionLog> m_log;
+  std::unordered_map<Socket *, Ptr<ShortFlowTxState> > m_txStates;
+};
+
+ShortFlowTracer::ShortFlowTracer (Ptr<Sender> sender, Ptr<FlowCompletionLog> log)
+  : m_sender (sender),
+    m_log (log)
+{
+}
+
+void
+ShortFlowTracer::SocketCreated (Ptr<Socket> socket)
+{
+  Ptr<TcpSocketBase> tcpSocket = DynamicCast<TcpSocketBase> (socket);
+  NS_ABORT_MSG_UNLESS (tcpSocket, "Short flow socket is not an ns-3 TCP socket");
+  tcpSocket->SetCongestionControlAlgorithm (ProfiledCongestionOps::Wrap (m_sender->CreateCongestionOps ()));
+
+  Ptr<ShortFlowTxState> state = Create<ShortFlowTxState> ();
+  state->sender = m_sender;
+  socket->TraceConnectWithoutContext ("Tx", MakeBoundCallback (&ShortFlowTx, state));
+  m_txStates [PeekPointer (socket)] = state;
+}
+
+void
+ShortFlowTracer::FlowEnded (Ptr<Socket> socket)
+{
+  auto it = m_txStates.find (PeekPointer (socket));
+  if (it != m_txStates.end ())
+    {
+      socket->TraceDisconnectWithoutContext ("Tx", MakeBoundCallback (&ShortFlowTx, it->second));
+      m_txStates.erase (it);
+    }
+}
+
+void
+ShortFlowTracer::FlowCompleted (uint64_t size, Time fct)
+{
+  ProfileScope scope (PROFILE_TRACES);
+  m_log->Add (m_sender->GetFlow (), FlowCompletionLog::COMPLETED, size, fct);
+}
+
+void
+ShortFlowTracer::FlowFailed (uint64_t size, Time fct)
+{
+  ProfileScope scope (PROFILE_TRACES);
+  m_log->Add (m_sender->GetFlow (), FlowCompletionLog::FAILED, size, fct);
+}
+
+void
+ShortFlowTracer::FlowCensored (uint64_t size, Time fct)
+{
+  ProfileScope scope (PROFILE_TRACES);
+  m_log->Add (m_sender->GetFlow (), FlowCompletionLog::CENSORED, size, fct);
+}
+
+size_t
+ShortFlowTracer::GetOpenFlows () const
+{
+  return m_txStates.size ();
+}
+
+/**
+ * Samples the per-flow state held for the short flow workload: the flows in
+ * progress at the senders, the sockets traced by the example, the open
+ * sockets of the sink and the TCP sockets of the nodes, TIME_WAIT included.
+ * All of it follows the flows in flight, not the flows started so far.
+ */
+class ShortFlowStateSampler : public SimpleRefCount<ShortFlowStateSampler>
+{
+public:
+  ShortFlowStateSampler (Ptr<OutputStreamWrapper> stream, Time step);
+
+  void AddSender (Ptr<ShortFlowApplication> app, Ptr<ShortFlowTracer> tracer);
+  void SetSink (Ptr<ShortFlowSink> sink);
+
+  // Writes one sample and schedules the next one
+  void Sample (void);
+
+private:
+  Ptr<OutputStreamWrapper> m_stream;
+  Time m_step;
+  std::vector<Ptr<ShortFlowApplication> > m_apps;
+  std::vector<Ptr<ShortFlowTracer> > m_tracers;
+  Ptr<ShortFlowSink> m_sink;
+  NodeContainer m_nodes;              // Nodes whose TCP sockets are counted
+};
+
+ShortFlowStateSampler::ShortFlowStateSampler (Ptr<OutputStreamWrapper> stream, Time step)
+  : m_stream (stream),
+    m_step (step)
+{
+  *m_stream->GetStream () << "# time senderFlows tracedFlows sinkSockets tcpSockets" << std::endl;
+}
+
+void
+ShortFlowStateSampler::AddSender (Ptr<ShortFlowApplication> app, Ptr<ShortFlowTracer> tracer)
+{
+  m_apps.push_back (app);
+  m_tracers.push_back (tracer);
+  m_nodes.Add (app->GetNode ());
+}
+
+void
+ShortFlowStateSampler::SetSink (Ptr<ShortFlowSink> sink)
+{
+  m_sink = sink;
+  m_nodes.Add (sink->GetNode ());
+}
+
+void
+ShortFlowStateSampler::Sample (void)
+{
+  size_t senderFlows = 0;
+  for (Ptr<ShortFlowApplication> app : m_apps)
+    {
+      senderFlows += app->GetOpenFlows ();
+    }
+  size_t tracedFlows = 0;
+  for (Ptr<ShortFlowTracer> tracer : m_tracers)
+    {
+      tracedFlows += tracer->GetOpenFlows ();
+    }
+  size_t tcpSockets = 0;
+  for (NodeContainer::Iterator it = m_nodes.Begin (); it != m_nodes.End (); ++it)
+    {
+      ObjectVectorValue sockets;
+      (*it)->GetObject<TcpL4Protocol> ()->GetAttribute ("SocketList", sockets);
+      tcpSockets += sockets.GetN ();
+    }
+  *m_stream->GetStream () << Simulator::Now ().GetSeconds () << " " << senderFlows << " " << tracedFlows
+                          << " " << (m_sink ? m_sink->GetOpenSockets () : 0) << " " << tcpSockets << std::endl;
+  Simulator::Schedule (m_step, &ShortFlowStateSampler::Sample, Ptr<ShortFlowStateSampler> (this));
+}
+
+// Writes the congestion control state of all the senders
+static void
+WriteCheckpoint (std::string fileName, uint32_t segmentSize, std::vector<Ptr<Sender> > senders)
+{
+  std::ofstream os (fileName.c_str (), std::ios::out | std::ios::trunc);
+  os << "time " << Simulator::Now ().GetSeconds () << "\n";
+  for (Ptr<Sender> sender : senders)
+    {
+      if (sender)
+        {
+          sender->WriteCheckpoint (os, segmentSize);
+        }
+    }
+  os.close ();
+}
+
+// Checkpoint file of this rank: the rank suffix goes before the extension,
+// e.g. checkpoint-rank2.txt; unchanged in serial runs
+static std::string
+RankFileName (std::string fileName, std::string rankSuffix)
+{
+  size_t dot = fileName.rfind ('.');
+  if (dot == std::string::npos || fileName.find ('/', dot) != std::string::npos)
+    {
+      return fileName + rankSuffix;
+    }
+  return fileName.substr (0, dot) + rankSuffix + fileName.substr (dot);
 }
 
-// Function to calculate drops in a particular Queue
-static void
-DropAtQueue (Ptr<OutputStreamWrapper> stream, Ptr<const QueueDiscItem> item)
+// Loads the sender states of a checkpoint, by flow
+static std::map<uint32_t, std::string>
+ReadCheckpoint (std::string fileName)
 {
-  *stream->GetStream () << Simulator::Now ().GetSeconds () << " 1" << std::endl;
+  std::ifstream is (fileName.c_str ());
+  NS_ABORT_MSG_UNLESS (is.is_open (), "Cannot open checkpoint " << fileName);
+  std::map<uint32_t, std::string> states;
+  std::string line;
+  while (std::getline (is, line))
+    {
+      std::istringstream ls (line);
+      std::string key;
+      uint32_t flow;
+      if ((ls >> key) && key == "flow" && (ls >> flow))
+        {
+          std::getline (ls >> std::ws, states [flow]);
+        }
+    }
+  return states;
 }
 
-// Trace Function for cwnd
-void
-TraceCwnd (uint32_t node, uint32_t cwndWindow,
-           Callback <void, uint32_t, uint32_t> CwndTrace)
+// Congestion control factory of an ns-3 protocol name, e.g. TcpVeno
+ObjectFactory
+CongestionFactory (std::string prot)
 {
-  Config::ConnectWithoutContext ("/NodeList/" + std::to_string (node) + "/$ns3::TcpL4Protocol/SocketList/" + std::to_string (cwndWindow) + "/CongestionWindow", CwndTrace);
+  ObjectFactory factory;
+  if (prot == "TcpWestwoodPlus")
+    {
+      // TcpWestwoodPlus is not an actual TypeId name; we need TcpWestwood here
+      factory.SetTypeId (TcpWestwood::GetTypeId ());
+      factory.Set ("ProtocolType", EnumValue (TcpWestwood::WESTWOODPLUS));
+      return factory;
+    }
+  TypeId tid;
+  NS_ABORT_MSG_UNLESS (TypeId::LookupByNameFailSafe ("ns3::" + prot, &tid), "TypeId ns3::" << prot << " not found");
+  factory.SetTypeId (tid);
+  return factory;
 }
 
 // Function to install BulkSend application
 void InstallBulkSend (Ptr<Node> node, Ipv4Address address, uint16_t port, std::string sock_factory,
-                      uint32_t nodeId, uint32_t cwndWindow,
-                      Callback <void, uint32_t, uint32_t> CwndTrace)
+                      Ptr<Sender> sender)
 {
-  BulkSendHelper source (sock_factory, InetSocketAddress (address, port));
-  source.SetAttribute ("MaxBytes", UintegerValue (0));
+  // The senders open their sockets with the TCP of their node; sock_factory
+  // only tells this variant apart from the DCE one.
+  NS_ABORT_MSG_UNLESS (sock_factory == "ns3::TcpSocketFactory",
+                       "Per-flow congestion control needs ns3::TcpSocketFactory, not " << sock_factory);
+  // Every socket of the factory is reported to this flow, so a node
+  // carries a single per-flow sender.
+  NS_ABORT_MSG_IF (node->GetObject<HookedTcpSocketFactory> (),
+                   "Node " << node->GetId () << " already has a per-flow sender");
+  Ptr<HookedTcpSocketFactory> socketFactory = CreateObject<HookedTcpSocketFactory> ();
+  node->AggregateObject (socketFactory);
+  socketFactory->TraceConnectWithoutContext ("SocketCreated", MakeCallback (&Sender::SocketCreated, sender));
+
+  BulkSendHelper source ("ns3::HookedTcpSocketFactory", InetSocketAddress (address, port));
+  source.SetAttribute ("MaxBytes", UintegerValue (maxBytes));
   ApplicationContainer sourceApps = source.Install (node);
-  sourceApps.Start (Seconds (10.0));
-  Simulator::Schedule (Seconds (10.0) + Seconds (0.001), &TraceCwnd, nodeId, cwndWindow, CwndTrace);
+  sourceApps.Start (Seconds (startTime));
   sourceApps.Stop (Seconds (stopTime));
 }
 
 void InstallBulkSend (Ptr<Node> node, Ipv4Address address, uint16_t port, std::string sock_factory)
 {
   BulkSendHelper source (sock_factory, InetSocketAddress (address, port));
-  source.SetAttribute ("MaxBytes", UintegerValue (0));
+  source.SetAttribute ("MaxBytes", UintegerValue (maxBytes));
   ApplicationContainer sourceApps = source.Install (node);
-  sourceApps.Start (Seconds (10.0));
+  sourceApps.Start (Seconds (startTime));
   sourceApps.Stop (Seconds (stopTime));
 }
 
+// Function to install the short flow workload of a sender
+void InstallShortFlows (Ptr<Node> node, Ipv4Address address, uint16_t port, std::string sock_factory,
+                        const FlowSizeCdf &cdf, double arrivalRate, uint32_t maxFlows, Ptr<Sender> sender,
+                        Ptr<FlowCompletionLog> log, int64_t stream, Ptr<ShortFlowStateSampler> sampler)
+{
+  Ptr<ShortFlowApplication> app = CreateObject<ShortFlowApplication> ();
+  app->SetAttribute ("Protocol", TypeIdValue (TypeId::LookupByName (sock_factory)));
+  app->SetAttribute ("Remote", AddressValue (InetSocketAddress (address, port)));
+  app->SetAttribute ("ArrivalRate", DoubleValue (arrivalRate));
+  app->SetAttribute ("MaxFlows", UintegerValue (maxFlows));
+  app->SetFlowSizeCdf (cdf);
+  app->AssignStreams (stream);
+  Ptr<ShortFlowTracer> tracer = Create<ShortFlowTracer> (sender, log);
+  app->TraceConnectWithoutContext ("SocketCreated", MakeCallback (&ShortFlowTracer::SocketCreated, tracer));
+  app->TraceConnectWithoutContext ("FlowEnded", MakeCallback (&ShortFlowTracer::FlowEnded, tracer));
+  app->TraceConnectWithoutContext ("FlowCompleted", MakeCallback (&ShortFlowTracer::FlowCompleted, tracer));
+  app->TraceConnectWithoutContext ("FlowFailed", MakeCallback (&ShortFlowTracer::FlowFailed, tracer));
+  app->TraceConnectWithoutContext ("FlowCensored", MakeCallback (&ShortFlowTracer::FlowCensored, tracer));
+  sampler->AddSender (app, tracer);
+  node->AddApplication (app);
+  app->SetStartTime (Seconds (startTime));
+  app->SetStopTime (Seconds (stopTime));
+}
+
 // Function to install sink application
-void InstallPacketSink (Ptr<Node> node, uint16_t port, std::string sock_factory)
+ApplicationContainer InstallPacketSink (Ptr<Node> node, uint16_t port, std::string sock_factory)
 {
   PacketSinkHelper sink (sock_factory, InetSocketAddress (Ipv4Address::GetAny (), port));
   ApplicationContainer sinkApps = sink.Install (node);
-  sinkApps.Start (Seconds (10.0));
+  sinkApps.Start (Seconds (startTime));
+  sinkApps.Stop (Seconds (stopTime));
+  return sinkApps;
+}
+
+// Function to install the sink of the short flow workload
+ApplicationContainer InstallShortFlowSink (Ptr<Node> node, uint16_t port, std::string sock_factory)
+{
+  Ptr<ShortFlowSink> app = CreateObject<ShortFlowSink> ();
+  app->SetAttribute ("Protocol", TypeIdValue (TypeId::LookupByName (sock_factory)));
+  app->SetAttribute ("Local", AddressValue (InetSocketAddress (Ipv4Address::GetAny (), port)));
+  node->AddApplication (app);
+  ApplicationContainer sinkApps (app);
+  sinkApps.Start (Seconds (startTime));
   sinkApps.Stop (Seconds (stopTime));
+  return sinkApps;
+}
+
+// Total bytes received by a PacketSink or a ShortFlowSink
+uint64_t
+SinkTotalRx (Ptr<Application> app)
+{
+  Ptr<PacketSink> sink = DynamicCast<PacketSink> (app);
+  return sink ? sink->GetTotalRx () : DynamicCast<ShortFlowSink> (app)->GetTotalRx ();
+}
+
+// Splits a comma separated command line value
+std::vector<std::string>
+SplitList (std::string list)
+{
+  std::vector<std::string> items;
+  std::istringstream is (list);
+  std::string item;
+  while (std::getline (is, item, ','))
+    {
+      if (!item.empty ())
+        {
+          items.push_back (item);
+        }
+    }
+  return items;
 }
 
-// Function to run "ss -a -e -i" command on a particular node having Linux stack
+// Function to run "ss -a -e -i" command on a particular node having Linux stack,
+// after the given delay
 static void GetSSStats (Ptr<Node> node, Time at, std::string stack)
 {
+  ProfileScope scope (PROFILE_SS_STATS);
   if (stack == "linux")
     {
       DceApplicationHelper process;
@@ -136,16 +1522,71 @@ int main (int argc, char *argv[])
 {
   uint32_t stream = 1;
   std::string stack = "linux";
-  std::string sock_factory = "ns3::TcpSocketFactory";
   std::string transport_prot = "TcpNewReno";
   std::string linux_prot = "reno";
   std::string queue_disc_type = "FifoQueueDisc";
   bool isSack = false;
   bool isWindowScale = false;
   bool isBql = false;
+  bool isHyStart = false;
+  bool isEcn = false;
+  uint32_t nSenders = 1;
+  bool isMpi = false;
+  bool isPcap = true;
+  std::string pcapNodes = "";
+  std::string pcapFlows = "";
+  double pcapStart = 0;
+  double pcapStop = 0;
+  uint32_t pcapSnapLen = 65535;
+  bool pcapHeadersOnly = false;
+  std::string scenario = "none";
+  std::string lossLink = "bottleneck";
+  double lossRate = 0.01;
+  double gePGoodToBad = 0.01;
+  double gePBadToGood = 0.3;
+  double geBadLoss = 0.5;
+  double varyInterval = 5.0;
+  double varyRateFactor = 0.5;
+  std::string varyDelay = "30ms";
+  std::string jitter = "0ms";
+  std::string classifier = "Diff";
+  double checkpointAt = 0;
+  std::string checkpointFile = "";
+  std::string restoreFrom = "";
   uint32_t dataSize = 524;
   uint32_t delAckCount = 1;
   std::string recovery = "TcpClassicRecovery";
+  bool isProfile = false;
+  double profileInterval = 1.0;
+  std::string flowProts = "";
+  std::string accessDelays = "";
+  std::string flowStacks = "linux,ns3";
+  bool isFairness = false;
+  double fairnessWindow = 1.0;
+  double fairnessStep = 0.1;
+  bool isShortFlows = false;
+  std::string shortFlowCdf = "websearch";
+  double shortFlowLoad = 0.5;
+  uint32_t shortFlowMax = 0;
+  double shortFlowMsl = 1;
+  bool isPacing = false;
+  double pacingGain = 1.2;
+  std::string studyFile = "";
+  std::string liveSocket = "";
+  double liveInterval = 0.5;
+  std::string venoSamples = "none";
+  uint32_t venoSampleEvery = 10;
+  uint32_t venoSampleReservoir = 100000;
+  std::string config = "";
+  std::string bottleneckRate = "1Mbps";
+  std::string bottleneckDelay = "10ms";
+  std::string accessRate = "10Mbps";
+  std::string accessDelay = "1ms";
+  std::string receiverDelay = "1ms";
+  std::string queueSize = "100p";
+  uint32_t sndBufSize = 1 << 20;
+  uint32_t rcvBufSize = 1 << 20;
+  uint32_t initialCwnd = 10;
 
   // Enable checksum if Linux and ns-3 node communicate
   GlobalValue::Bind ("ChecksumEnabled", BooleanValue (true));
@@ -162,7 +1603,8 @@ int main (int argc, char *argv[])
 
   CommandLine cmd;
   cmd.AddValue ("stream", "Seed value for random variable", stream);
-  cmd.AddValue ("stack", "Set TCP/IP stack as ns3 or linux", stack);
+  cmd.AddValue ("stack", "Set TCP/IP stack as ns3, linux or mixed", stack);
+  cmd.AddValue ("flowStacks", "Comma separated stack of each sender with stack=mixed, e.g. linux,ns3", flowStacks);
   cmd.AddValue ("transport_prot", "Transport protocol to use: TcpNewReno, "
                 "TcpHybla, TcpHighSpeed, TcpHtcp, TcpVegas, TcpScalable, TcpVeno, "
                 "TcpBic, TcpYeah, TcpIllinois, TcpWestwood, TcpWestwoodPlus, TcpLedbat, "
@@ -175,18 +1617,183 @@ int main (int argc, char *argv[])
   cmd.AddValue ("delAckCount", "Delayed ack count", delAckCount);
   cmd.AddValue ("Sack", "Flag to enable/disable sack in TCP", isSack);
   cmd.AddValue ("WindowScaling", "Flag to enable/disable window scaling in TCP", isWindowScale);
+  cmd.AddValue ("startTime", "Start time for applications", startTime);
   cmd.AddValue ("stopTime", "Stop time for applications / simulation time will be stopTime", stopTime);
+  cmd.AddValue ("checkpointAt", "Time at which the ns-3 sender state is checkpointed (0 disables)", checkpointAt);
+  cmd.AddValue ("checkpointFile", "File written by checkpointAt (default: checkpoint.txt in the results directory)", checkpointFile);
+  cmd.AddValue ("restoreFrom", "Checkpoint the ns-3 senders are warm-started from", restoreFrom);
   cmd.AddValue ("recovery", "Recovery algorithm type to use (e.g., ns3::TcpPrrRecovery", recovery);
   cmd.AddValue ("BQL", "Flag to enable/disable BQL for ns-3 stack", isBql);
+  cmd.AddValue ("nSenders", "Number of sender nodes sharing the bottleneck", nSenders);
+  cmd.AddValue ("mpi", "Distribute the simulation over MPI ranks (run through mpirun, ns-3 stack only)", isMpi);
+  cmd.AddValue ("pcap", "Flag to enable/disable PCAP capture", isPcap);
+  cmd.AddValue ("pcapNodes", "Comma separated ids of the nodes to capture on (default: all)", pcapNodes);
+  cmd.AddValue ("pcapFlows", "Comma separated names of the flows to capture, e.g. A,C (default: all)", pcapFlows);
+  cmd.AddValue ("pcapStart", "Start time of the capture", pcapStart);
+  cmd.AddValue ("pcapStop", "Stop time of the capture (default: stopTime)", pcapStop);
+  cmd.AddValue ("pcapSnapLen", "Maximum number of bytes captured per packet", pcapSnapLen);
+  cmd.AddValue ("pcapHeadersOnly", "Capture only the PPP, IPv4 and TCP headers of each packet", pcapHeadersOnly);
+  cmd.AddValue ("ecn", "Flag to enable/disable ECN at the senders and the gateway queue disc", isEcn);
+  cmd.AddValue ("HyStart", "Flag to enable/disable HyStart slow start exit for ns-3 stack", isHyStart);
+  cmd.AddValue ("maxBytes", "Bytes sent by the BulkSend application (0 means unlimited)", maxBytes);
+  cmd.AddValue ("scenario", "Wireless scenario preset: none, iid, gilbert or varying", scenario);
+  cmd.AddValue ("lossLink", "Link carrying the error model: bottleneck or access", lossLink);
+  cmd.AddValue ("lossRate", "Packet loss rate of the iid scenario", lossRate);
+  cmd.AddValue ("gePGoodToBad", "Good to bad transition probability of the gilbert scenario", gePGoodToBad);
+  cmd.AddValue ("gePBadToGood", "Bad to good transition probability of the gilbert scenario", gePBadToGood);
+  cmd.AddValue ("geBadLoss", "Loss probability in the bad state of the gilbert scenario", geBadLoss);
+  cmd.AddValue ("varyInterval", "Seconds between capacity/delay changes of the varying scenario", varyInterval);
+  cmd.AddValue ("varyRateFactor", "Degraded/nominal bottleneck capacity of the varying scenario", varyRateFactor);
+  cmd.AddValue ("varyDelay", "Degraded bottleneck delay of the varying scenario", varyDelay);
+  cmd.AddValue ("jitter", "Maximum extra delay of each packet towards the receiver, without reordering", jitter);
+  cmd.AddValue ("classifier", "TcpVeno loss classifier: Diff or RttDistribution", classifier);
+  cmd.AddValue ("flowProts", "Comma separated protocol of each sender, e.g. TcpVeno,TcpNewReno (default: transport_prot or linux_prot)", flowProts);
+  cmd.AddValue ("accessDelays", "Comma separated delay of each sender access link, e.g. 1ms,50ms (default: 1ms)", accessDelays);
+  cmd.AddValue ("fairness", "Report per-flow goodput shares, Jain's index and utilization in fairness.txt", isFairness);
+  cmd.AddValue ("fairnessWindow", "Length in seconds of the sliding window of the fairness benchmark", fairnessWindow);
+  cmd.AddValue ("fairnessStep", "Seconds between two windows of the fairness benchmark", fairnessStep);
+  cmd.AddValue ("shortFlows", "Replace the BulkSend flows by a Poisson workload of short flows (ns-3 stack only)", isShortFlows);
+  cmd.AddValue ("shortFlowCdf", "Flow size distribution: websearch, datamining or a file of <bytes> <cdf> lines", shortFlowCdf);
+  cmd.AddValue ("shortFlowLoad", "Offered load of the short flows, as a fraction of the bottleneck capacity", shortFlowLoad);
+  cmd.AddValue ("shortFlowMax", "Number of short flows started by each sender (0 means until stopTime)", shortFlowMax);
+  cmd.AddValue ("shortFlowMsl", "Maximum segment lifetime of the short flow sockets; they stay 2 MSL in TIME_WAIT", shortFlowMsl);
+  cmd.AddValue ("pacing", "Flag to enable/disable pacing of the TcpVeno senders", isPacing);
+  cmd.AddValue ("pacingGain", "Pacing rate of TcpVeno as a multiple of cwnd / minRtt", pacingGain);
+  cmd.AddValue ("studyFile", "File the drop rate, queue occupancy percentiles and goodput of the run are appended to", studyFile);
+  cmd.AddValue ("liveSocket", "Unix socket path the live metrics are sent to (default: none)", liveSocket);
+  cmd.AddValue ("liveInterval", "Simulated seconds between two live metrics snapshots", liveInterval);
+  cmd.AddValue ("venoSamples", "Record the TcpVeno samples of the ns-3 senders: none, all, downsample or reservoir", venoSamples);
+  cmd.AddValue ("venoSampleEvery", "Samples out of which one is recorded with venoSamples=downsample", venoSampleEvery);
+  cmd.AddValue ("venoSampleReservoir", "Samples kept per flow with venoSamples=reservoir", venoSampleReservoir);
+  cmd.AddValue ("profile", "Report the wall time spent per category of events in profile.txt", isProfile);
+  cmd.AddValue ("profileInterval", "Simulated seconds between two samples of the simulation speed", profileInterval);
+  cmd.AddValue ("config", "File describing the topology, links, queue and flows of the run", config);
+  cmd.AddValue ("bottleneckRate", "Capacity of the bottleneck link", bottleneckRate);
+  cmd.AddValue ("bottleneckDelay", "Delay of the bottleneck link", bottleneckDelay);
+  cmd.AddValue ("accessRate", "Capacity of the access links", accessRate);
+  cmd.AddValue ("accessDelay", "Delay of the sender access links without accessDelays entry", accessDelay);
+  cmd.AddValue ("receiverDelay", "Delay of the receiver access link", receiverDelay);
+  cmd.AddValue ("queueSize", "Size of the gateway queue disc, e.g. 100p or 64KB", queueSize);
+  cmd.AddValue ("sndBufSize", "TCP send buffer size in bytes", sndBufSize);
+  cmd.AddValue ("rcvBufSize", "TCP receive buffer size in bytes", rcvBufSize);
+  cmd.AddValue ("initialCwnd", "TCP initial congestion window in segments", initialCwnd);
+
+  // The config file is applied first, so that the command line overrides it
+  RunConfig runConfig;
+  for (int i = 1; i < argc; i++)
+    {
+      std::string arg (argv [i]);
+      if (arg.compare (0, 9, "--config=") == 0)
+        {
+          config = arg.substr (9);
+        }
+    }
+  if (!config.empty ())
+    {
+      runConfig = LoadRunConfig (config);
+      std::vector<char *> configArgv (1, argv [0]);
+      for (std::string &arg : runConfig.args)
+        {
+          configArgv.push_back (&arg [0]);
+        }
+      cmd.Parse (static_cast<int> (configArgv.size ()), configArgv.data ());
+    }
   cmd.Parse (argc,argv);
 
+  NS_ABORT_MSG_UNLESS (nSenders >= 1 && nSenders <= 250, "nSenders must be between 1 and 250");
+  if (isMpi)
+    {
+#ifdef DCE_MPI
+      GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::DistributedSimulatorImpl"));
+      MpiInterface::Enable (&argc, &argv);
+#else
+      NS_FATAL_ERROR ("Distributed runs need DCE configured with --enable-mpi");
+#endif
+    }
+
   uv->SetStream (stream);
+  if (isProfile)
+    {
+      Profiler::Enable ();
+    }
   queue_disc_type = std::string ("ns3::") + queue_disc_type;
 
+  // Protocol and access link delay of each sender; the lists are repeated
+  // when there are more senders than entries
+  NS_ABORT_MSG_UNLESS (stack == "linux" || stack == "ns3" || stack == "mixed", "Unknown stack " << stack);
+  std::vector<std::string> flowStackList = SplitList (flowStacks);
+  NS_ABORT_MSG_IF (flowStackList.empty (), "flowStacks is empty");
+  std::vector<std::string> flowProtList = SplitList (flowProts);
+  std::vector<std::string> flowProtocols;
+  std::vector<std::string> flowStack;
+  std::vector<std::string> accessDelayList = SplitList (accessDelays);
+  std::vector<std::string> flowDelays;
+  for (uint32_t i = 0; i < nSenders; i++)
+    {
+      flowStack.push_back ((stack == "mixed") ? flowStackList [i % flowStackList.size ()] : stack);
+      NS_ABORT_MSG_UNLESS (flowStack [i] == "linux" || flowStack [i] == "ns3", "Unknown stack " << flowStack [i] << " in flowStacks");
+      flowProtocols.push_back (flowProtList.empty () ? ((flowStack [i] == "ns3") ? transport_prot : linux_prot)
+                               : flowProtList [i % flowProtList.size ()]);
+      flowDelays.push_back (accessDelayList.empty () ? accessDelay : accessDelayList [i % accessDelayList.size ()]);
+
+      // Parameters of the flow in the config file
+      auto flowConfig = runConfig.flows.find (i);
+      if (flowConfig != runConfig.flows.end ())
+        {
+          std::map<std::string, std::string> &params = flowConfig->second;
+          if (params.count ("stack"))
+            {
+              NS_ABORT_MSG_UNLESS (stack == "mixed" || params ["stack"] == stack,
+                                   "Flow " << i << " of " << config << " needs stack=mixed");
+              NS_ABORT_MSG_UNLESS (params ["stack"] == "linux" || params ["stack"] == "ns3", "Unknown stack " << params ["stack"]);
+              flowStack [i] = params ["stack"];
+              if (!params.count ("protocol") && flowProtList.empty ())
+                {
+                  flowProtocols [i] = (flowStack [i] == "ns3") ? transport_prot : linux_prot;
+                }
+            }
+          if (params.count ("protocol"))
+            {
+              flowProtocols [i] = params ["protocol"];
+            }
+          if (params.count ("accessDelay"))
+            {
+              flowDelays [i] = params ["accessDelay"];
+            }
+        }
+    }
+  NS_ABORT_MSG_UNLESS (runConfig.flows.empty () || runConfig.flows.rbegin ()->first < nSenders,
+                       "Flow " << runConfig.flows.rbegin ()->first << " of " << config << " is beyond nSenders");
+  NS_ABORT_MSG_UNLESS (initialCwnd > 0 && sndBufSize > 0 && rcvBufSize > 0,
+                       "initialCwnd, sndBufSize and rcvBufSize must be positive");
+  NS_ABORT_MSG_UNLESS (fairnessStep > 0 && fairnessWindow >= fairnessStep, "fairnessWindow must be at least fairnessStep > 0");
+
+  NS_ABORT_MSG_UNLESS (venoSamples == "none" || venoSamples == "all" || venoSamples == "downsample" || venoSamples == "reservoir",
+                       "Unknown venoSamples mode " << venoSamples);
+  venosamples::Mode venoSampleMode = venosamples::MODE_ALL;
+  uint32_t venoSampleParameter = 1;
+  if (venoSamples == "downsample")
+    {
+      NS_ABORT_MSG_UNLESS (venoSampleEvery > 0, "venoSampleEvery must be positive");
+      venoSampleMode = venosamples::MODE_DOWNSAMPLE;
+      venoSampleParameter = venoSampleEvery;
+    }
+  else if (venoSamples == "reservoir")
+    {
+      NS_ABORT_MSG_UNLESS (venoSampleReservoir > 0, "venoSampleReservoir must be positive");
+      venoSampleMode = venosamples::MODE_RESERVOIR;
+      venoSampleParameter = venoSampleReservoir;
+    }
+
   transport_prot = std::string ("ns3::") + transport_prot;
+  std::string protocolLabel = (stack == "ns3") ? transport_prot : (stack == "linux") ? linux_prot : transport_prot + "+" + linux_prot;
 
   recovery = std::string ("ns3::") + recovery;
 
+  NS_ABORT_MSG_UNLESS (scenario == "none" || scenario == "iid" || scenario == "gilbert" || scenario == "varying",
+                       "Unknown scenario " << scenario);
+  NS_ABORT_MSG_UNLESS (lossLink == "bottleneck" || lossLink == "access", "Unknown lossLink " << lossLink);
+
   TypeId qdTid;
   NS_ABORT_MSG_UNLESS (TypeId::LookupByNameFailSafe (queue_disc_type, &qdTid), "TypeId " << queue_disc_type << " not found");
 
@@ -206,43 +1813,125 @@ int main (int argc, char *argv[])
       Config::SetDefault ("ns3::TcpL4Protocol::SocketType", TypeIdValue (TypeId::LookupByName (transport_prot)));
     }
 
+  // Split the scenario when running over MPI: the left router is simulated
+  // by rank 0, the right router and the receiver by rank 1, and the senders
+  // are dealt in turn to rank 0 and ranks 2 and above, cutting their access
+  // links. The lookahead of the ranks is the shortest delay of a link
+  // between two ranks, i.e. the bottleneck or the shortest access link of a
+  // sender away from rank 0.
+  uint32_t systemCount = 1;
+  std::string rankSuffix = "";
+#ifdef DCE_MPI
+  if (MpiInterface::IsEnabled ())
+    {
+      NS_ABORT_MSG_UNLESS (stack == "ns3", "Distributed runs are only supported with the ns-3 stack");
+      // The loss and classifier counters are kept by the rank that sees the
+      // event and are not reduced across ranks
+      NS_ABORT_MSG_UNLESS (scenario == "none", "The wireless scenarios are not supported in distributed runs");
+      NS_ABORT_MSG_IF (Time (bottleneckDelay).IsZero (), "Distributed runs need a bottleneck delay above 0 as lookahead");
+      systemCount = MpiInterface::GetSize ();
+      rankSuffix = "-rank" + std::to_string (MpiInterface::GetSystemId ());
+      // All the ranks write to the directory named by rank 0
+      MPI_Bcast (buffer, sizeof (buffer), MPI_CHAR, 0, MPI_COMM_WORLD);
+      currentTime = std::string (buffer);
+    }
+#endif
+  std::vector<uint32_t> senderRanks (1, 0);
+  for (uint32_t rank = 2; rank < systemCount; rank++)
+    {
+      senderRanks.push_back (rank);
+    }
+  uint32_t rightRank = std::min<uint32_t> (1, systemCount - 1);
+
   // Create nodes
   NodeContainer leftNodes, rightNodes, routers;
-  routers.Create (2);
-  leftNodes.Create (1);
-  rightNodes.Create (1);
+  routers.Create (1, 0);
+  routers.Create (1, rightRank);
+  Time lookahead = Time (bottleneckDelay);
+  for (uint32_t i = 0; i < nSenders; i++)
+    {
+      uint32_t rank = senderRanks [i % senderRanks.size ()];
+      if (rank != 0)
+        {
+          NS_ABORT_MSG_IF (Time (flowDelays [i]).IsZero (),
+                           "Distributed runs need access delays above 0 as lookahead");
+          lookahead = std::min (lookahead, Time (flowDelays [i]));
+        }
+      leftNodes.Create (1, rank);
+    }
+  rightNodes.Create (1, rightRank);
 
   std::vector <NetDeviceContainer> leftToRouter;
   std::vector <NetDeviceContainer> routerToRight;
 
   // Create the point-to-point link helpers and connect two router nodes
   PointToPointHelper pointToPointRouter;
-  pointToPointRouter.SetDeviceAttribute  ("DataRate", StringValue ("1Mbps"));
-  pointToPointRouter.SetChannelAttribute ("Delay", StringValue ("10ms"));
+  pointToPointRouter.SetDeviceAttribute  ("DataRate", StringValue (bottleneckRate));
+  pointToPointRouter.SetChannelAttribute ("Delay", StringValue (bottleneckDelay));
   NetDeviceContainer r1r2ND = pointToPointRouter.Install (routers.Get (0), routers.Get (1));
 
   // Create the point-to-point link helpers and connect leaf nodes to router
   PointToPointHelper pointToPointLeaf;
-  pointToPointLeaf.SetDeviceAttribute    ("DataRate", StringValue ("10Mbps"));
-  pointToPointLeaf.SetChannelAttribute   ("Delay", StringValue ("1ms"));
-  leftToRouter.push_back (pointToPointLeaf.Install (leftNodes.Get (0), routers.Get (0)));
+  pointToPointLeaf.SetDeviceAttribute    ("DataRate", StringValue (accessRate));
+  pointToPointLeaf.SetChannelAttribute   ("Delay", StringValue (accessDelay));
+  for (uint32_t i = 0; i < leftNodes.GetN (); i++)
+    {
+      pointToPointLeaf.SetChannelAttribute ("Delay", StringValue (flowDelays [i]));
+      leftToRouter.push_back (pointToPointLeaf.Install (leftNodes.Get (i), routers.Get (0)));
+    }
+  pointToPointLeaf.SetChannelAttribute ("Delay", StringValue (receiverDelay));
   routerToRight.push_back (pointToPointLeaf.Install (routers.Get (1), rightNodes.Get (0)));
 
+  // Install the error model of the wireless scenario on the receiving side
+  // of the bottleneck link, or of the receiver's access link
+  Ptr<NetDevice> lossDevice = (lossLink == "bottleneck") ? r1r2ND.Get (1) : routerToRight [0].Get (1);
+  Ptr<ErrorModel> errorModel;
+  if (scenario == "iid")
+    {
+      Ptr<RateErrorModel> em = CreateObject<RateErrorModel> ();
+      em->SetUnit (RateErrorModel::ERROR_UNIT_PACKET);
+      em->SetRate (lossRate);
+      em->AssignStreams (stream);
+      errorModel = em;
+    }
+  else if (scenario == "gilbert")
+    {
+      Ptr<GilbertElliottErrorModel> em = CreateObject<GilbertElliottErrorModel> ();
+      em->SetAttribute ("PGoodToBad", DoubleValue (gePGoodToBad));
+      em->SetAttribute ("PBadToGood", DoubleValue (gePBadToGood));
+      em->SetAttribute ("BadLoss", DoubleValue (geBadLoss));
+      em->AssignStreams (stream);
+      errorModel = em;
+    }
+  else if (scenario == "varying")
+    {
+      Simulator::Schedule (Seconds (startTime), &VaryBottleneck, r1r2ND,
+                           DataRate (bottleneckRate), Time (bottleneckDelay),
+                           DataRate (static_cast<uint64_t> (DataRate (bottleneckRate).GetBitRate () * varyRateFactor)),
+                           Time (varyDelay), Seconds (varyInterval), false);
+    }
+  if (errorModel)
+    {
+      lossDevice->SetAttribute ("ReceiveErrorModel", PointerValue (errorModel));
+    }
+
   DceManagerHelper dceManager;
   LinuxStackHelper linuxStack;
   InternetStackHelper internetStack;
 
-  if (stack == "linux")
+  // Senders running the Linux stack through DCE and the ns-3 stack
+  NodeContainer linuxSenders, ns3Senders;
+  for (uint32_t i = 0; i < leftNodes.GetN (); i++)
     {
-      sock_factory = "ns3::LinuxTcpSocketFactory";
-      dceManager.SetTaskManagerAttribute ("FiberManagerType", StringValue ("UcontextFiberManager"));
-      dceManager.SetNetworkStack ("ns3::LinuxSocketFdFactory", "Library", StringValue ("liblinux.so"));
-      linuxStack.Install (leftNodes);
+      (flowStack [i] == "linux" ? linuxSenders : ns3Senders).Add (leftNodes.Get (i));
     }
-  else
+  if (linuxSenders.GetN () > 0)
     {
-      internetStack.Install (leftNodes);
+      dceManager.SetTaskManagerAttribute ("FiberManagerType", StringValue ("UcontextFiberManager"));
+      dceManager.SetNetworkStack ("ns3::LinuxSocketFdFactory", "Library", StringValue ("liblinux.so"));
+      linuxStack.Install (linuxSenders);
     }
+  internetStack.Install (ns3Senders);
   internetStack.Install (rightNodes);
   internetStack.Install (routers);
 
@@ -253,8 +1942,11 @@ int main (int argc, char *argv[])
   ipAddresses.NewNetwork ();
 
   std::vector <Ipv4InterfaceContainer> leftToRouterIPAddress;
-  leftToRouterIPAddress.push_back (ipAddresses.Assign (leftToRouter [0]));
-  ipAddresses.NewNetwork ();
+  for (uint32_t i = 0; i < leftNodes.GetN (); i++)
+    {
+      leftToRouterIPAddress.push_back (ipAddresses.Assign (leftToRouter [i]));
+      ipAddresses.NewNetwork ();
+    }
 
   std::vector <Ipv4InterfaceContainer> routerToRightIPAddress;
   routerToRightIPAddress.push_back (ipAddresses.Assign (routerToRight [0]));
@@ -263,22 +1955,35 @@ int main (int argc, char *argv[])
   dceManager.Install (rightNodes);
   dceManager.Install (routers);
 
-  // Set configuration for Linux stack and create routing table for each node
-  if (stack == "linux")
+  // Set configuration for Linux stack
+  if (linuxSenders.GetN () > 0)
     {
       // Enable IP forwarding in Linux stack
-      linuxStack.SysctlSet (leftNodes, ".net.ipv4.conf.default.forwarding", "1");
-      // Sets TCP Congestion Control algorithm in Linux stack
-      linuxStack.SysctlSet (leftNodes, ".net.ipv4.tcp_congestion_control", linux_prot);
+      linuxStack.SysctlSet (linuxSenders, ".net.ipv4.conf.default.forwarding", "1");
+      // Sets TCP Congestion Control algorithm of each sender in Linux stack
+      for (uint32_t i = 0; i < leftNodes.GetN (); i++)
+        {
+          if (flowStack [i] == "linux")
+            {
+              linuxStack.SysctlSet (leftNodes.Get (i), ".net.ipv4.tcp_congestion_control", flowProtocols [i]);
+            }
+        }
       // Enable/Disable Window Scaling in TCP for Linux stack
-      linuxStack.SysctlSet (leftNodes, ".net.ipv4.tcp_window_scaling", ((isWindowScale)) ? "1" : "0");
+      linuxStack.SysctlSet (linuxSenders, ".net.ipv4.tcp_window_scaling", ((isWindowScale)) ? "1" : "0");
       // Enable/Disable SACK in TCP for Linux stack
-      linuxStack.SysctlSet (leftNodes, ".net.ipv4.tcp_sack", ((isSack) ? "1" : "0"));
+      linuxStack.SysctlSet (linuxSenders, ".net.ipv4.tcp_sack", ((isSack) ? "1" : "0"));
       // Disable FACK in TCP for Linux stack
-      linuxStack.SysctlSet (leftNodes, ".net.ipv4.tcp_fack", "0");
+      linuxStack.SysctlSet (linuxSenders, ".net.ipv4.tcp_fack", "0");
       // Disable DSACK in TCP for Linux stack
-      linuxStack.SysctlSet (leftNodes, ".net.ipv4.tcp_dsack", "0");
+      linuxStack.SysctlSet (linuxSenders, ".net.ipv4.tcp_dsack", "0");
+      // Enable/Disable ECN in TCP for Linux stack
+      linuxStack.SysctlSet (linuxSenders, ".net.ipv4.tcp_ecn", ((isEcn) ? "1" : "0"));
+    }
 
+  // Create routing table for each node: static routes as soon as a sender
+  // runs the Linux stack, global routing otherwise
+  if (linuxSenders.GetN () > 0)
+    {
       // Static Routing
       Ptr<Ipv4> ipv4Router1 = routers.Get (0)->GetObject<Ipv4> ();
       Ptr<Ipv4> ipv4Router2 = routers.Get (1)->GetObject<Ipv4> ();
@@ -290,33 +1995,54 @@ int main (int argc, char *argv[])
       Ptr<Ipv4StaticRouting> staticRoutingRouter2 = routingHelper.GetStaticRouting (ipv4Router2);
       Ptr<Ipv4StaticRouting> staticRoutingReceiver = routingHelper.GetStaticRouting (ipv4Receiver);
 
+      Ipv4Mask mask ("255.255.255.0");
+
       // Routing for Router 1
-      staticRoutingRouter1->AddNetworkRouteTo (Ipv4Address ("10.0.2.0"), Ipv4Mask ("255.255.255.0"), Ipv4Address ("10.0.0.2"), 1);
+      staticRoutingRouter1->AddNetworkRouteTo (routerToRightIPAddress [0].GetAddress (1).CombineMask (mask), mask, r1r2IPAddress.GetAddress (1), 1);
 
-      // Routing for Router 2
-      staticRoutingRouter2->AddNetworkRouteTo (Ipv4Address ("10.0.1.0"), Ipv4Mask ("255.255.255.0"), Ipv4Address ("10.0.0.1"), 1);
+      for (uint32_t i = 0; i < leftNodes.GetN (); i++)
+        {
+          Ipv4Address leftNetwork = leftToRouterIPAddress [i].GetAddress (0).CombineMask (mask);
 
-      // Routing for Receiver
-      staticRoutingReceiver->AddNetworkRouteTo (Ipv4Address ("10.0.1.0"), Ipv4Mask ("255.255.255.0"), Ipv4Address ("10.0.2.1"), 1);
+          // Routing for Router 2
+          staticRoutingRouter2->AddNetworkRouteTo (leftNetwork, mask, r1r2IPAddress.GetAddress (0), 1);
 
-      std::ostringstream cmd_oss;
+          // Routing for Receiver
+          staticRoutingReceiver->AddNetworkRouteTo (leftNetwork, mask, routerToRightIPAddress [0].GetAddress (0), 1);
 
-      // Default route for sender
-      cmd_oss.str ("");
-      cmd_oss << "route add default via " << (routers.Get (0)->GetObject<Ipv4> ())->GetAddress (2, 0).GetLocal () << " dev sim0";
-      LinuxStackHelper::RunIp (leftNodes.Get (0), Seconds (0.00001), cmd_oss.str ());
-      LinuxStackHelper::RunIp (leftNodes.Get (0), Seconds (0.00001), "link set sim0 up");
+          // Default route for sender
+          if (flowStack [i] == "ns3")
+            {
+              routingHelper.GetStaticRouting (leftNodes.Get (i)->GetObject<Ipv4> ())->SetDefaultRoute (leftToRouterIPAddress [i].GetAddress (1), 1);
+              continue;
+            }
+          std::ostringstream cmd_oss;
+          cmd_oss.str ("");
+          cmd_oss << "route add default via " << leftToRouterIPAddress [i].GetAddress (1) << " dev sim0";
+          LinuxStackHelper::RunIp (leftNodes.Get (i), Seconds (0.00001), cmd_oss.str ());
+          LinuxStackHelper::RunIp (leftNodes.Get (i), Seconds (0.00001), "link set sim0 up");
+        }
     }
-  else if (stack == "ns3")
+  else
     {
       Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
     }
 
-  // Sets default sender and receiver buffer size as 1MB
-  Config::SetDefault ("ns3::TcpSocket::SndBufSize", UintegerValue (1 << 20));
-  Config::SetDefault ("ns3::TcpSocket::RcvBufSize", UintegerValue (1 << 20));
-  // Sets default initial congestion window as 10 segments
-  Config::SetDefault ("ns3::TcpSocket::InitialCwnd", UintegerValue (10));
+  // Enable/Disable HyStart in TcpNewReno and the variants derived from it
+  Config::SetDefault ("ns3::TcpNewReno::HyStart", BooleanValue (isHyStart));
+
+  // Sets the loss classification rule of TcpVeno
+  Config::SetDefault ("ns3::TcpVeno::LossClassifier", StringValue (classifier));
+
+  // Enable/Disable pacing in TcpVeno
+  Config::SetDefault ("ns3::TcpVeno::Pacing", BooleanValue (isPacing));
+  Config::SetDefault ("ns3::TcpVeno::PacingGain", DoubleValue (pacingGain));
+
+  // Sets default sender and receiver buffer size (1MB by default)
+  Config::SetDefault ("ns3::TcpSocket::SndBufSize", UintegerValue (sndBufSize));
+  Config::SetDefault ("ns3::TcpSocket::RcvBufSize", UintegerValue (rcvBufSize));
+  // Sets default initial congestion window (10 segments by default)
+  Config::SetDefault ("ns3::TcpSocket::InitialCwnd", UintegerValue (initialCwnd));
   // Sets default delayed ack count to a specified value
   Config::SetDefault ("ns3::TcpSocket::DelAckCount", UintegerValue (delAckCount));
   // Sets default segment size of TCP packet to a specified value
@@ -325,6 +2051,11 @@ int main (int argc, char *argv[])
   Config::SetDefault ("ns3::TcpSocketBase::Sack", BooleanValue (isSack));
   // Enable/Disable Window Scaling in TCP
   Config::SetDefault ("ns3::TcpSocketBase::WindowScaling", BooleanValue (isWindowScale));
+  // Release the closed short flow sockets sooner than the default 2 x 120 s
+  if (isShortFlows)
+    {
+      Config::SetDefault ("ns3::TcpSocketBase::MaxSegLifetime", DoubleValue (shortFlowMsl));
+    }
 
   // Creates directories to store plotme files
   dir += (currentTime + "/");
@@ -332,13 +2063,27 @@ int main (int argc, char *argv[])
   system (dirToSave.c_str ());
   system ((dirToSave + "/pcap/").c_str ());
   system ((dirToSave + "/queueTraces/").c_str ());
-  if (stack == "ns3")
+  if (stack != "linux")
     {
       system ((dirToSave + "/cwndTraces/").c_str ());
     }
+  if (stack != "linux" && venoSamples != "none")
+    {
+      system ((dirToSave + "/venoSamples/").c_str ());
+    }
 
   // Set default parameters for queue discipline
-  Config::SetDefault (queue_disc_type + "::MaxSize", QueueSizeValue (QueueSize ("100p")));
+  Config::SetDefault (queue_disc_type + "::MaxSize", QueueSizeValue (QueueSize (queueSize)));
+
+  // Enable/Disable ECN in TCP and, for the AQMs supporting it, ECN marking at the gateway
+  Config::SetDefault ("ns3::TcpSocketBase::UseEcn", StringValue (isEcn ? "On" : "Off"));
+  struct TypeId::AttributeInformation ecnInfo;
+  bool canMark = qdTid.LookupAttributeByName ("UseEcn", &ecnInfo);
+  NS_ABORT_MSG_IF (isEcn && !canMark, queue_disc_type << " does not mark packets, use a queue disc supporting ECN");
+  if (canMark)
+    {
+      Config::SetDefault (queue_disc_type + "::UseEcn", BooleanValue (isEcn));
+    }
 
   AsciiTraceHelper asciiTraceHelper;
   Ptr<OutputStreamWrapper> streamWrapper;
@@ -346,89 +2091,512 @@ int main (int argc, char *argv[])
   // Install queue discipline on router
   TrafficControlHelper tch;
   tch.SetRootQueueDisc (queue_disc_type);
+
+  // Enables BQL; the queue limits are set up when the queue disc is installed
+  if (isBql)
+    {
+      tch.SetQueueLimits ("ns3::DynamicQueueLimits");
+    }
+
   QueueDiscContainer qd;
   tch.Uninstall (routers.Get (0)->GetDevice (0));
   qd.Add (tch.Install (routers.Get (0)->GetDevice (0)).Get (0));
 
-  // Enables BQL
-  if (isBql)
+  // Delays the packets towards the receiver by up to jitter, in order
+  if (Time (jitter).IsStrictlyPositive ())
     {
-      tch.SetQueueLimits ("ns3::DynamicQueueLimits");
+      TrafficControlHelper jitterTch;
+      jitterTch.SetRootQueueDisc ("ns3::JitterQueueDisc", "Jitter", TimeValue (Time (jitter)));
+      jitterTch.Uninstall (routerToRight [0].Get (0));
+      Ptr<QueueDisc> jitterQd = jitterTch.Install (routerToRight [0].Get (0)).Get (0);
+      DynamicCast<JitterQueueDisc> (jitterQd)->AssignStreams (stream);
     }
 
   // Calls function to check queue size
+  Ptr<QueueOccupancy> queueOccupancy = Create<QueueOccupancy> (Seconds (startTime));
   if (stack == "linux")
     {
-      Simulator::ScheduleNow (&LinuxCheckQueueSize, qd.Get (0));
+      Simulator::ScheduleNow (&LinuxCheckQueueSize, qd.Get (0), queueOccupancy);
     }
-  else if (stack == "ns3")
+  else if (IsLocal (routers.Get (0)))
     {
-      Simulator::ScheduleNow (&ns3CheckQueueSize, qd.Get (0));
+      Simulator::ScheduleNow (&ns3CheckQueueSize, qd.Get (0), queueOccupancy);
     }
 
-  // Create plotme to store packets dropped and marked at the router
-  streamWrapper = asciiTraceHelper.CreateFileStream (dir + "/queueTraces/drop-0.plotme");
-  qd.Get (0)->TraceConnectWithoutContext ("Drop", MakeBoundCallback (&DropAtQueue, streamWrapper));
+  // Record the packets dropped and marked at the router, with their flow
+  std::map<uint32_t, uint32_t> flowByAddress;
+  std::map<uint32_t, uint32_t> ns3FlowByAddress;
+  std::vector<std::string> flowNames;
+  for (uint32_t i = 0; i < leftNodes.GetN (); i++)
+    {
+      flowByAddress [leftToRouterIPAddress [i].GetAddress (0).Get ()] = i;
+      flowNames.push_back (FlowName (leftNodes.Get (i)));
+      if (flowStack [i] == "ns3")
+        {
+          ns3FlowByAddress [leftToRouterIPAddress [i].GetAddress (0).Get ()] = i;
+        }
+    }
+  Ptr<QueueEventTracer> queueEvents;
+  if (IsLocal (routers.Get (0)))
+    {
+      queueEvents = Create<QueueEventTracer> (dir + "queueTraces/", qd.Get (0), flowByAddress, leftNodes.GetN ());
+      qd.Get (0)->TraceConnectWithoutContext ("Drop", MakeCallback (&QueueEventTracer::Drop, queueEvents));
+      qd.Get (0)->TraceConnectWithoutContext ("Mark", MakeCallback (&QueueEventTracer::Mark, queueEvents));
+    }
+
+  // Count the losses, marks and queueing delay, and score the loss
+  // classification of the ns-3 senders
+  Ptr<LossClassifier> lossClassifier = Create<LossClassifier> (ns3FlowByAddress, leftNodes.GetN ());
+  if (errorModel)
+    {
+      lossDevice->TraceConnectWithoutContext ("PhyRxDrop", MakeCallback (&LossClassifier::ErrorModelDrop, lossClassifier));
+    }
+  qd.Get (0)->TraceConnectWithoutContext ("Drop", MakeCallback (&LossClassifier::QueueDiscDrop, lossClassifier));
+  qd.Get (0)->TraceConnectWithoutContext ("SojournTime", MakeCallback (&LossClassifier::QueueDiscSojourn, lossClassifier));
+  qd.Get (0)->TraceConnectWithoutContext ("Mark", MakeCallback (&LossClassifier::QueueDiscMark, lossClassifier));
 
   // Install packet sink at receiver side
   uint16_t port = 50000;
-  InstallPacketSink (rightNodes.Get (0), port, "ns3::TcpSocketFactory");
+  ApplicationContainer sinkApps;
+  if (IsLocal (rightNodes.Get (0)))
+    {
+      sinkApps = isShortFlows ? InstallShortFlowSink (rightNodes.Get (0), port, "ns3::TcpSocketFactory")
+        : InstallPacketSink (rightNodes.Get (0), port, "ns3::TcpSocketFactory");
+    }
 
-  // Install BulkSend application
-  if (stack == "linux")
+  // Create a file to store the flow completion time of a finite transfer
+  if (maxBytes > 0 && sinkApps.GetN () > 0)
     {
-      InstallBulkSend (leftNodes.Get (0), routerToRightIPAddress [0].GetAddress (1), port, sock_factory);
+      streamWrapper = asciiTraceHelper.CreateFileStream (dir + "fct.txt");
+      Ptr<FctRecorder> fctRecorder = Create<FctRecorder> (streamWrapper, flowByAddress, flowNames, maxBytes, Seconds (startTime));
+      sinkApps.Get (0)->TraceConnectWithoutContext ("Rx", MakeCallback (&FctRecorder::Rx, fctRecorder));
     }
-  else if (stack == "ns3")
+
+  // Measure the goodput of every flow at the sink for the fairness benchmark
+  // and the live metrics
+  Ptr<FairnessMonitor> fairness;
+  if ((isFairness || !liveSocket.empty ()) && sinkApps.GetN () > 0)
+    {
+      fairness = Create<FairnessMonitor> (flowByAddress, leftNodes.GetN ());
+      sinkApps.Get (0)->TraceConnectWithoutContext ("Rx", MakeCallback (&FairnessMonitor::Rx, fairness));
+    }
+  if (isFairness && sinkApps.GetN () > 0)
     {
-      InstallBulkSend (leftNodes.Get (0), routerToRightIPAddress [0].GetAddress (1), port, sock_factory, 2, 0, MakeCallback (&CwndChangeA));
+      fairness->SetWindows (asciiTraceHelper.CreateFileStream (dir + "fairness.plotme"), Seconds (fairnessStep),
+                            static_cast<uint32_t> (fairnessWindow / fairnessStep + 0.5),
+                            static_cast<double> (DataRate (bottleneckRate).GetBitRate ()));
+      Simulator::Schedule (Seconds (startTime), &FairnessMonitor::Sample, fairness);
     }
 
-  // Calls function to run ss command on Linux stack after every 0.05 seconds
-  if (stack == "linux")
+  // Load the checkpoint the ns-3 senders are warm-started from
+  std::map<uint32_t, std::string> restoredState;
+  if (!restoreFrom.empty ())
+    {
+      NS_ABORT_MSG_UNLESS (stack != "linux", "Checkpoints are only supported with the ns-3 stack");
+      restoredState = ReadCheckpoint (RankFileName (restoreFrom, rankSuffix));
+    }
+  bool senderCheckpoints = (checkpointAt > 0 || !restoreFrom.empty ()) && stack != "linux";
+
+  // Install BulkSend application, or the short flow workload, on every sender
+  NS_ABORT_MSG_UNLESS (!isShortFlows || stack == "ns3", "The short flow workload needs the ns-3 stack");
+  std::unique_ptr<FlowSizeCdf> flowSizeCdf;
+  double arrivalRate = 0;
+  Ptr<ShortFlowStateSampler> shortFlowSampler;
+  Ptr<FlowCompletionLog> flowCompletions;
+  if (isShortFlows)
+    {
+      flowCompletions = Create<FlowCompletionLog> ();
+      flowSizeCdf.reset (new FlowSizeCdf (shortFlowCdf));
+      arrivalRate = shortFlowLoad * DataRate (bottleneckRate).GetBitRate () / (8 * flowSizeCdf->GetMean ()) / nSenders;
+      // Tracks the state held for the flows, once per simulated second
+      shortFlowSampler = Create<ShortFlowStateSampler> (asciiTraceHelper.CreateFileStream (dir + "shortFlowState" + rankSuffix + ".plotme"),
+                                                        Seconds (1));
+      if (sinkApps.GetN () > 0)
+        {
+          shortFlowSampler->SetSink (DynamicCast<ShortFlowSink> (sinkApps.Get (0)));
+        }
+      Simulator::Schedule (Seconds (startTime), &ShortFlowStateSampler::Sample, shortFlowSampler);
+    }
+  // The ns-3 senders of this process, by flow; the Linux senders and those
+  // of other ranks have no entry
+  std::vector<Ptr<Sender> > senders (leftNodes.GetN ());
+  for (uint32_t i = 0; i < leftNodes.GetN (); i++)
+    {
+      Ptr<Node> node = leftNodes.Get (i);
+      std::string flowName = FlowName (node);
+      if (!IsLocal (node))
+        {
+          continue;
+        }
+      if (flowStack [i] == "linux")
+        {
+          InstallBulkSend (node, routerToRightIPAddress [0].GetAddress (1), port, "ns3::LinuxTcpSocketFactory");
+          continue;
+        }
+      senders [i] = Create<Sender> (i, CongestionFactory (flowProtocols [i]));
+      if (isShortFlows)
+        {
+          InstallShortFlows (node, routerToRightIPAddress [0].GetAddress (1), port, "ns3::TcpSocketFactory",
+                             *flowSizeCdf, arrivalRate, shortFlowMax, senders [i], flowCompletions,
+                             stream + 100 + 2 * i, shortFlowSampler);
+          continue;
+        }
+      senders [i]->SetTraceStreams (asciiTraceHelper.CreateFileStream (dir + "cwndTraces/" + flowName + "-ns3.plotme"),
+                                    asciiTraceHelper.CreateFileStream (dir + "cwndTraces/" + flowName + "-ns3-ssthresh.plotme"));
+      senders [i]->SetLossClassifier (lossClassifier);
+      if (senderCheckpoints)
+        {
+          senders [i]->EnableCheckpoints ();
+        }
+      auto restored = restoredState.find (i);
+      if (restored != restoredState.end ())
+        {
+          senders [i]->SetRestoredState (restored->second);
+        }
+      if (venoSamples != "none")
+        {
+          // Apart from the streams of the topology and of the short flows
+          senders [i]->RecordVenoSamples (dir + "venoSamples/" + flowName + "-ns3.bin", venoSampleMode,
+                                          venoSampleParameter, stream + 1000 + i);
+        }
+      InstallBulkSend (node, routerToRightIPAddress [0].GetAddress (1), port, "ns3::TcpSocketFactory", senders [i]);
+    }
+
+  // Write the checkpoint of the ns-3 senders
+  if (checkpointAt > 0 && stack != "linux")
+    {
+      if (checkpointFile.empty ())
+        {
+          checkpointFile = dir + "checkpoint.txt";
+        }
+      checkpointFile = RankFileName (checkpointFile, rankSuffix);
+      Simulator::Schedule (Seconds (checkpointAt), &WriteCheckpoint, checkpointFile, dataSize, senders);
+    }
+
+  // Calls function to run ss command on Linux stack after every 0.05 seconds.
+  // The ss applications are installed up front, or from events when
+  // profiling so that their installation is part of the profile.
+  for (uint32_t j = 0; j < leftNodes.GetN (); j++)
     {
-      for (int j = 0; j < leftNodes.GetN (); j++)
+      if (flowStack [j] != "linux")
+        {
+          continue;
+        }
+      for (float i = startTime; i <= stopTime; i = i + 0.05)
         {
-          for (float i = 10.0; i <= stopTime; i = i + 0.05)
+          if (Profiler::IsEnabled ())
+            {
+              Simulator::Schedule (Seconds (i), &GetSSStats, leftNodes.Get (j), Seconds (0), flowStack [j]);
+            }
+          else
             {
-              GetSSStats (leftNodes.Get (j), Seconds (i), stack);
+              GetSSStats (leftNodes.Get (j), Seconds (i), flowStack [j]);
             }
         }
     }
 
-  // Enables PCAP on all the point to point interfaces
-  if (stack == "linux")
+  // Enables PCAP on the selected point to point interfaces simulated by this process
+  std::vector<Ptr<BufferedPcapWriter> > pcapWriters;
+  if (isPcap)
+    {
+      std::set<uint32_t> captureNodes;
+      for (std::string id : SplitList (pcapNodes))
+        {
+          captureNodes.insert (std::stoul (id));
+        }
+      std::set<uint32_t> captureAddresses;
+      for (std::string flow : SplitList (pcapFlows))
+        {
+          bool found = false;
+          for (uint32_t i = 0; i < leftNodes.GetN (); i++)
+            {
+              if (FlowName (leftNodes.Get (i)) == flow)
+                {
+                  captureAddresses.insert (leftToRouterIPAddress [i].GetAddress (0).Get ());
+                  found = true;
+                }
+            }
+          NS_ABORT_MSG_UNLESS (found, "Unknown flow " << flow << " in pcapFlows");
+        }
+      std::string prefix = dir + ((stack == "linux") ? "pcap/Linux" : (stack == "mixed") ? "pcap/mixed" : "pcap/ns-3" + rankSuffix);
+      for (NodeContainer::Iterator it = NodeContainer::GetGlobal ().Begin (); it != NodeContainer::GetGlobal ().End (); ++it)
+        {
+          Ptr<Node> node = *it;
+          if (!IsLocal (node) || (!captureNodes.empty () && captureNodes.count (node->GetId ()) == 0))
+            {
+              continue;
+            }
+          for (uint32_t j = 0; j < node->GetNDevices (); j++)
+            {
+              Ptr<PointToPointNetDevice> device = DynamicCast<PointToPointNetDevice> (node->GetDevice (j));
+              if (!device)
+                {
+                  continue;
+                }
+              Ptr<BufferedPcapWriter> writer = Create<BufferedPcapWriter> (
+                  prefix + "-" + std::to_string (node->GetId ()) + "-" + std::to_string (device->GetIfIndex ()) + ".pcap",
+                  pcapSnapLen, pcapHeadersOnly, Seconds (pcapStart),
+                  Seconds (pcapStop > 0 ? pcapStop : stopTime), captureAddresses);
+              device->TraceConnectWithoutContext ("PromiscSniffer", MakeCallback (&BufferedPcapWriter::Capture, writer));
+              pcapWriters.push_back (writer);
+            }
+        }
+    }
+
+  // Publishes the live metrics of the run
+  Ptr<LivePublisher> livePublisher;
+  if (!liveSocket.empty ())
     {
-      pointToPointLeaf.EnablePcapAll (dir + "pcap/Linux", true);
+      NS_ABORT_MSG_UNLESS (liveInterval > 0, "liveInterval must be positive");
+      livePublisher = Create<LivePublisher> (liveSocket + rankSuffix, IsLocal (routers.Get (0)) ? qd.Get (0) : Ptr<QueueDisc> (),
+                                             flowNames, dataSize);
+      livePublisher->AddSource (MakeCallback (&LossClassifier::FillSnapshot, lossClassifier));
+      if (fairness)
+        {
+          livePublisher->AddSource (MakeCallback (&FairnessMonitor::FillSnapshot, fairness));
+        }
+      for (Ptr<Sender> sender : senders)
+        {
+          if (sender)
+            {
+              livePublisher->AddSource (MakeCallback (&Sender::FillSnapshot, sender));
+            }
+        }
+      Simulator::ScheduleNow (&LivePublisher::Publish, livePublisher, Seconds (liveInterval));
     }
-  else
+
+  if (Profiler::IsEnabled ())
     {
-      pointToPointLeaf.EnablePcapAll (dir + "pcap/ns-3", true);
+      NS_ABORT_MSG_UNLESS (profileInterval > 0, "profileInterval must be positive");
+      Profiler::StartSampling (Seconds (profileInterval));
     }
 
   Simulator::Stop (Seconds (stopTime));
+  std::chrono::steady_clock::time_point wallStart = std::chrono::steady_clock::now ();
   Simulator::Run ();
+  std::chrono::duration<double> wallTime = std::chrono::steady_clock::now () - wallStart;
 
-  // Stores queue stats in a file
+  // Stores the wall-clock time of the run in a file
   std::ofstream myfile;
-  myfile.open (dir + "queueStats.txt", std::fstream::in | std::fstream::out | std::fstream::app);
-  myfile << std::endl;
-  myfile << "Stat for Queue 1";
-  myfile << qd.Get (0)->GetStats ();
+  myfile.open (dir + "runTime" + rankSuffix + ".txt", std::fstream::in | std::fstream::out | std::fstream::app);
+  myfile << "ranks " << systemCount << "\n";
+  myfile << "nSenders " << nSenders << "\n";
+  if (systemCount > 1)
+    {
+      myfile << "lookahead(s) " << lookahead.GetSeconds () << "\n";
+    }
+  myfile << "wallClock(s) " << wallTime.count () << "\n";
+  uint64_t pcapBytes = 0;
+  double pcapWriteTime = 0;
+  for (Ptr<BufferedPcapWriter> writer : pcapWriters)
+    {
+      writer->Flush ();
+      pcapBytes += writer->GetBytesWritten ();
+      pcapWriteTime += writer->GetWriteSeconds ();
+    }
+  myfile << "pcapBytes " << pcapBytes << "\n";
+  myfile << "pcapWrite(s) " << pcapWriteTime << "\n";
+  if (livePublisher)
+    {
+      myfile << "liveSnapshotsSent " << livePublisher->GetSent () << "\n";
+      myfile << "liveSnapshotsDropped " << livePublisher->GetDropped () << "\n";
+    }
+  myfile.close ();
+
+  // Stores the wall time per category of events and the simulation speed
+  if (Profiler::IsEnabled ())
+    {
+      myfile.open (dir + "profile" + rankSuffix + ".txt", std::fstream::out | std::fstream::trunc);
+      uint64_t events = Simulator::GetEventCount ();
+      double attributed = 0;
+      myfile << "# category calls wall(s) share(%) mean(us)\n";
+      for (uint32_t c = 0; c < PROFILE_CATEGORIES; c++)
+        {
+          const ProfileCounter &counter = Profiler::GetCounter (static_cast<ProfileCategory> (c));
+          attributed += counter.seconds;
+          myfile << Profiler::GetName (static_cast<ProfileCategory> (c)) << " " << counter.calls << " " << counter.seconds << " "
+                 << 100 * counter.seconds / wallTime.count () << " "
+                 << (counter.calls ? counter.seconds / counter.calls * 1e6 : 0.0) << "\n";
+        }
+      // TCP, queue discs, devices, DCE tasks and the scheduler itself
+      myfile << "other " << events << " " << wallTime.count () - attributed << " "
+             << 100 * (wallTime.count () - attributed) / wallTime.count () << " 0\n";
+      // Part of pcapCapture, plus the final flush
+      myfile << "pcapWrite " << pcapWriters.size () << " " << pcapWriteTime << " "
+             << 100 * pcapWriteTime / wallTime.count () << " 0\n";
+      myfile << "events " << events << "\n";
+      myfile << "wallClock(s) " << wallTime.count () << "\n";
+      myfile << "eventsPerWallSecond " << events / wallTime.count () << "\n";
+      myfile << "simSecondsPerWallSecond " << (Simulator::Now ().GetSeconds ()) / wallTime.count () << "\n";
+      myfile << "# simTime(s) simSecondsPerWallSecond eventsPerWallSecond\n";
+      const std::vector<ProfileSample> &profileSamples = Profiler::GetSamples ();
+      for (uint32_t i = 1; i < profileSamples.size (); i++)
+        {
+          double wall = profileSamples [i].wallTime - profileSamples [i - 1].wallTime;
+          if (wall > 0)
+            {
+              myfile << profileSamples [i].simTime << " "
+                     << (profileSamples [i].simTime - profileSamples [i - 1].simTime) / wall << " "
+                     << (profileSamples [i].events - profileSamples [i - 1].events) / wall << "\n";
+            }
+        }
+      myfile.close ();
+    }
+
+  // Stores queue stats in a file
+  if (queueEvents)
+    {
+      queueEvents->Flush ();
+      queueEvents->WriteFlowCounts (dir + "queueTraces/flowDrops-0.txt", flowNames);
+    }
+  for (Ptr<Sender> sender : senders)
+    {
+      if (sender)
+        {
+          sender->Close ();
+        }
+    }
+  if (IsLocal (routers.Get (0)))
+    {
+      myfile.open (dir + "queueStats.txt", std::fstream::in | std::fstream::out | std::fstream::app);
+      myfile << std::endl;
+      myfile << "Stat for Queue 1";
+      myfile << qd.Get (0)->GetStats ();
+      myfile.close ();
+    }
+
+  // Stores goodput, loss classification accuracy and queueing delay of the scenario
+  myfile.open (dir + "scenarioStats" + rankSuffix + ".txt", std::fstream::in | std::fstream::out | std::fstream::app);
+  myfile << "scenario " << scenario << " lossLink " << lossLink << "\n";
+  myfile << "protocol " << protocolLabel << "\n";
+  if (sinkApps.GetN () > 0)
+    {
+      myfile << "goodput(Mbps) " << SinkTotalRx (sinkApps.Get (0)) * 8.0 / (stopTime - startTime) / 1e6 << "\n";
+    }
+  lossClassifier->WriteLosses (myfile);
+  if (stack != "linux")
+    {
+      for (uint32_t flow = 0; flow < senders.size (); flow++)
+        {
+          if (flowStack [flow] != "ns3")
+            {
+              continue;
+            }
+          myfile << "retransmissions " << flow << " " << (senders [flow] ? senders [flow]->GetRetransmissions () : 0) << "\n";
+        }
+    }
+  if (queueEvents)
+    {
+      for (uint32_t flow = 0; flow < leftNodes.GetN (); flow++)
+        {
+          myfile << "bottleneckDrops " << flow << " " << queueEvents->GetFlowDrops (flow) << "\n";
+        }
+    }
+  if (stack != "linux" && !isShortFlows)
+    {
+      lossClassifier->WriteClassification (myfile);
+    }
+  lossClassifier->WriteQueueingDelay (myfile);
   myfile.close ();
 
+  // Appends the row of this run to the pacing/BQL study table
+  if (!studyFile.empty () && IsLocal (routers.Get (0)) && sinkApps.GetN () > 0)
+    {
+      QueueDisc::Stats stats = qd.Get (0)->GetStats ();
+      std::ifstream existing (studyFile.c_str ());
+      bool header = !existing.good () || existing.peek () == std::ifstream::traits_type::eof ();
+      existing.close ();
+      myfile.open (studyFile.c_str (), std::fstream::out | std::fstream::app);
+      if (header)
+        {
+          myfile << "# protocol pacing BQL dropRate(%) queueP50 queueP90 queueP99 goodput(Mbps)\n";
+        }
+      myfile << protocolLabel << " " << isPacing << " " << isBql << " "
+             << (stats.nTotalReceivedPackets ? 100.0 * stats.nTotalDroppedPackets / stats.nTotalReceivedPackets : 0.0) << " "
+             << queueOccupancy->GetPercentile (50) << " " << queueOccupancy->GetPercentile (90) << " "
+             << queueOccupancy->GetPercentile (99) << " "
+             << SinkTotalRx (sinkApps.Get (0)) * 8.0 / (stopTime - startTime) / 1e6 << "\n";
+      myfile.close ();
+    }
+
+  // Stores the FCT percentiles of the short flow workload
+  if (isShortFlows)
+    {
+      flowCompletions->WriteStats (dir + "fctStats" + rankSuffix + ".txt", flowProtocols);
+    }
+
+  // Stores the results table of the fairness benchmark
+  if (isFairness && sinkApps.GetN () > 0)
+    {
+      myfile.open (dir + "fairness.txt", std::fstream::out | std::fstream::trunc);
+      std::vector<double> goodputs;
+      double total = 0;
+      for (uint32_t flow = 0; flow < leftNodes.GetN (); flow++)
+        {
+          goodputs.push_back (fairness->GetRxBytes (flow) * 8.0 / (stopTime - startTime));
+          total += goodputs.back ();
+        }
+      myfile << "# flow stack protocol accessDelay goodput(Mbps) share(%)\n";
+      for (uint32_t flow = 0; flow < goodputs.size (); flow++)
+        {
+          myfile << FlowName (leftNodes.Get (flow)) << " " << flowStack [flow] << " " << flowProtocols [flow] << " " << flowDelays [flow] << " "
+                 << goodputs [flow] / 1e6 << " " << (total > 0 ? 100 * goodputs [flow] / total : 0.0) << "\n";
+        }
+      myfile << "jainIndex " << JainIndex (goodputs) << "\n";
+      myfile << "utilization " << total / DataRate (bottleneckRate).GetBitRate () << "\n";
+      fairness->WriteWindowStats (myfile);
+      myfile.close ();
+    }
+
   // Stores configuration of the simulation in a file
-  myfile.open (dir + "config.txt", std::fstream::in | std::fstream::out | std::fstream::app);
+  myfile.open (dir + "config" + rankSuffix + ".txt", std::fstream::in | std::fstream::out | std::fstream::app);
   myfile << "queue_disc_type " << queue_disc_type << "\n";
   myfile << "stream  " << stream << "\n";
   myfile << "stack  " << stack << "\n";
-  (stack == "ns3") ? myfile << "transport_prot " << transport_prot << "\n" : myfile << "linux_prot " << linux_prot << "\n";
+  if (stack != "linux")
+    {
+      myfile << "transport_prot " << transport_prot << "\n";
+    }
+  if (stack != "ns3")
+    {
+      myfile << "linux_prot " << linux_prot << "\n";
+    }
+  if (stack == "mixed")
+    {
+      myfile << "flowStacks " << flowStacks << "\n";
+    }
   myfile << "dataSize " << dataSize << "\n";
   myfile << "delAckCount " << delAckCount << "\n";
+  myfile << "startTime " << startTime << "\n";
   myfile << "stopTime " << stopTime << "\n";
+  myfile << "restoreFrom " << restoreFrom << "\n";
+  myfile << "HyStart " << isHyStart << "\n";
+  myfile << "ecn " << isEcn << "\n";
+  myfile << "maxBytes " << maxBytes << "\n";
+  myfile << "scenario " << scenario << "\n";
+  myfile << "jitter " << jitter << "\n";
+  myfile << "classifier " << classifier << "\n";
+  myfile << "nSenders " << nSenders << "\n";
+  myfile << "profile " << isProfile << "\n";
+  myfile << "pacing " << isPacing << " gain " << pacingGain << "\n";
+  myfile << "BQL " << isBql << "\n";
+  myfile << "flowProts " << flowProts << "\n";
+  myfile << "accessDelays " << accessDelays << "\n";
+  myfile << "shortFlows " << isShortFlows << " " << shortFlowCdf << " load " << shortFlowLoad << "\n";
+  myfile << "config " << config << "\n";
+  myfile << "bottleneck " << bottleneckRate << " " << bottleneckDelay << "\n";
+  myfile << "access " << accessRate << " " << accessDelay << " receiver " << receiverDelay << "\n";
+  myfile << "queueSize " << queueSize << "\n";
+  myfile << "buffers " << sndBufSize << " " << rcvBufSize << " initialCwnd " << initialCwnd << "\n";
   myfile.close ();
 
   Simulator::Destroy ();
+#ifdef DCE_MPI
+  if (isMpi)
+    {
+      MpiInterface::Disable ();
+    }
+#endif
 
   return 0;
 }
@@ -0,0 +1,77 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "gilbert-elliott-error-model.h"
+#include "ns3/double.h"
+#include "ns3/packet.h"
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (GilbertElliottErrorModel);
+
+TypeId
+GilbertElliottErrorModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::GilbertElliottErrorModel")
+    .SetParent<ErrorModel> ()
+    .AddConstructor<GilbertElliottErrorModel> ()
+    .AddAttribute ("PGoodToBad", "Probability of moving from the good to the bad state",
+                   DoubleValue (0.01),
+                   MakeDoubleAccessor (&GilbertElliottErrorModel::m_pGoodToBad),
+                   MakeDoubleChecker<double> (0.0, 1.0))
+    .AddAttribute ("PBadToGood", "Probability of moving from the bad to the good state",
+                   DoubleValue (0.3),
+                   MakeDoubleAccessor (&GilbertElliottErrorModel::m_pBadToGood),
+                   MakeDoubleChecker<double> (0.0, 1.0))
+    .AddAttribute ("GoodLoss", "Loss probability in the good state",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&GilbertElliottErrorModel::m_goodLoss),
+                   MakeDoubleChecker<double> (0.0, 1.0))
+    .AddAttribute ("BadLoss", "Loss probability in the bad state",
+                   DoubleValue (0.5),
+                   MakeDoubleAccessor (&GilbertElliottErrorModel::m_badLoss),
+                   MakeDoubleChecker<double> (0.0, 1.0))
+  ;
+  return tid;
+}
+
+GilbertElliottErrorModel::GilbertElliottErrorModel ()
+  : m_bad (false)
+{
+  m_ranvar = CreateObject<UniformRandomVariable> ();
+}
+
+int64_t
+GilbertElliottErrorModel::AssignStreams (int64_t stream)
+{
+  m_ranvar->SetStream (stream);
+  return 1;
+}
+
+bool
+GilbertElliottErrorModel::DoCorrupt (Ptr<Packet> p)
+{
+  m_bad = m_bad ? (m_ranvar->GetValue () >= m_pBadToGood) : (m_ranvar->GetValue () < m_pGoodToBad);
+  return m_ranvar->GetValue () < (m_bad ? m_badLoss : m_goodLoss);
+}
+
+void
+GilbertElliottErrorModel::DoReset (void)
+{
+  m_bad = false;
+}
+
+} // namespace ns3
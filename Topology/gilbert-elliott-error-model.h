@@ -0,0 +1,61 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef GILBERT_ELLIOTT_ERROR_MODEL_H
+#define GILBERT_ELLIOTT_ERROR_MODEL_H
+
+#include "ns3/error-model.h"
+#include "ns3/random-variable-stream.h"
+
+namespace ns3 {
+
+/**
+ * Two-state Gilbert-Elliott packet error model. The channel moves between a
+ * good and a bad state once per packet; packets are lost with GoodLoss
+ * probability in the good state and with BadLoss probability in the bad state,
+ * which produces the bursty losses typical of wireless links.
+ */
+class GilbertElliottErrorModel : public ErrorModel
+{
+public:
+  static TypeId GetTypeId (void);
+
+  GilbertElliottErrorModel ();
+
+  /**
+   * Assign a fixed random variable stream number to the random variables
+   * used by this model.
+   *
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned by this model
+   */
+  int64_t AssignStreams (int64_t stream);
+
+private:
+  virtual bool DoCorrupt (Ptr<Packet> p);
+  virtual void DoReset (void);
+
+  bool m_bad;                         // True while the channel is in the bad state
+  double m_pGoodToBad;                // Transition probability good -> bad
+  double m_pBadToGood;                // Transition probability bad -> good
+  double m_goodLoss;                  // Loss probability in the good state
+  double m_badLoss;                   // Loss probability in the bad state
+  Ptr<UniformRandomVariable> m_ranvar;
+};
+
+} // namespace ns3
+
+#endif /* GILBERT_ELLIOTT_ERROR_MODEL_H */
@@ -0,0 +1,170 @@
+import glob
+import os
+import shutil
+import subprocess
+import sys
+
+# Records and checks golden cwnd traces of short deterministic
+# dumbbell scenarios, to catch changes of the Linux-parity behaviour of
+# TcpNewReno and TcpVeno (byte-counting slow start, packet-counting
+# congestion avoidance, 2*(cwnd - target) diff, ...).
+#
+# Run it from the ns-3-dce directory, with parse_cwnd.py copied in utils/:
+#
+#   python golden-trace.py record [--baseline] [scenario ...]   run and store the traces
+#   python golden-trace.py check [scenario ...]    run and compare with them
+#   python golden-trace.py compare golden.plotme trace.plotme
+#
+# record --baseline only records the scenarios the pre-series example can
+# run; see golden/README.md for recording them from the pre-series tree.
+#
+# Options: --golden=<dir> (default: golden/ next to this script),
+#          --time-tol=<s> (default 0.01), --value-tol=<segments> (default 0)
+
+RESULTS = "results/dumbbell-topology"
+
+# name: (stack, arguments, runs on the pre-series example)
+SCENARIOS = {
+  "ns3-newreno": ("ns3", "--stack=ns3 --transport_prot=TcpNewReno", True),
+  "ns3-veno": ("ns3", "--stack=ns3 --transport_prot=TcpVeno", True),
+  "ns3-veno-iid": ("ns3", "--stack=ns3 --transport_prot=TcpVeno --scenario=iid --lossRate=0.01", False),
+  "linux-reno": ("linux", "--stack=linux --linux_prot=reno", True),
+  "linux-veno": ("linux", "--stack=linux --linux_prot=veno", True),
+}
+# Only options the pre-series example knows; the flows start at 10 s
+COMMON = "--stream=1 --stopTime=20"
+# Golden traces of every scenario, by stack. Only the cwnd of the single
+# flow: the pre-series example traces no ssthresh.
+GOLDEN = {
+  "ns3": ["A-ns3.plotme"],
+  "linux": ["A-linux.plotme"],
+}
+
+
+def read_trace(path):
+  points = []
+  with open(path) as trace:
+    for line in trace:
+      fields = line.split()
+      if len(fields) >= 2 and not line.startswith("#"):
+        points.append((float(fields[0]), float(fields[1])))
+  return points
+
+
+def values_between(points, start, end):
+  # Values taken by the step function of the trace over [start, end]
+  values = []
+  for i, (time, value) in enumerate(points):
+    next_time = points[i + 1][0] if i + 1 < len(points) else float("inf")
+    if next_time >= start and time <= end:
+      values.append(value)
+  return values
+
+
+def unmatched(name, points, other, other_name, time_tol, value_tol, start):
+  # Points from start on that other does not take within time_tol seconds
+  # and value_tol segments
+  mismatches = 0
+  for time, value in points:
+    if time < start:
+      continue
+    values = values_between(other, time - time_tol, time + time_tol)
+    if not any(abs(v - value) <= value_tol for v in values):
+      if mismatches < 5:
+        print("  %s: %g at %gs, %s has %s" % (name, value, time, other_name,
+                                              " ".join("%g" % v for v in values[:5]) or "nothing"))
+      mismatches += 1
+  return mismatches
+
+
+def compare(golden_path, trace_path, time_tol, value_tol):
+  # Every golden point must be matched by the trace and every trace point by
+  # the golden trace; trace points before the first golden point are not
+  # checked, the pre-series example connects its cwnd trace after the start.
+  # Returns the number of mismatches.
+  golden = read_trace(golden_path)
+  trace = read_trace(trace_path)
+  name = os.path.basename(golden_path)
+  mismatches = unmatched(name, golden, trace, "trace", time_tol, value_tol, float("-inf"))
+  start = golden[0][0] - time_tol if golden else float("-inf")
+  mismatches += unmatched(name, trace, golden, "golden", time_tol, value_tol, start)
+  if len(trace) > 0 and len(golden) > 0 and trace[-1][0] > golden[-1][0] + time_tol:
+    print("  %s: trace continues after the golden trace" % os.path.basename(golden_path))
+    mismatches += 1
+  return mismatches
+
+
+def run_scenario(name):
+  stack, args, _ = SCENARIOS[name]
+  before = set(glob.glob(os.path.join(RESULTS, "*")))
+  if stack == "linux":
+    # parse_cwnd.py reads every ss log of the sender node
+    shutil.rmtree(os.path.join("files-2", "var", "log"), ignore_errors=True)
+  subprocess.check_call(["./waf", "--run", "dumbbelltopologyns3receiver " + args + " " + COMMON])
+  runs = [d for d in glob.glob(os.path.join(RESULTS, "*")) if d not in before and os.path.isdir(d)]
+  if stack == "ns3":
+    run = max(runs, key=os.path.getmtime)
+    return sorted(glob.glob(os.path.join(run, "cwndTraces", "*.plotme")))
+  subprocess.check_call(["python", "parse_cwnd.py", "2", "2"], cwd="utils")
+  return sorted(glob.glob(os.path.join(RESULTS, "cwnd_data", "*-linux*.plotme")))
+
+
+def main():
+  args = [a for a in sys.argv[1:] if not a.startswith("--")]
+  options = dict(a[2:].split("=", 1) for a in sys.argv[1:] if a.startswith("--") and "=" in a)
+  baseline = "--baseline" in sys.argv[1:]
+  golden_dir = options.get("golden", os.path.join(os.path.dirname(os.path.abspath(__file__)), "golden"))
+  time_tol = float(options.get("time-tol", 0.01))
+  value_tol = float(options.get("value-tol", 0))
+  if not args or args[0] not in ("record", "check", "compare"):
+    print("usage: golden-trace.py record [--baseline]|check [scenario ...] | compare golden trace")
+    return 2
+
+  if args[0] == "compare":
+    mismatches = compare(args[1], args[2], time_tol, value_tol)
+    print("%d mismatches" % mismatches)
+    return 1 if mismatches else 0
+
+  names = args[1:] or sorted(n for n in SCENARIOS if SCENARIOS[n][2] or not baseline)
+  unknown = [n for n in names if n not in SCENARIOS or (baseline and not SCENARIOS[n][2])]
+  if unknown:
+    print("unknown scenarios%s: %s" % (" on the pre-series example" if baseline else "", " ".join(unknown)))
+    return 2
+
+  failed = 0
+  for name in names:
+    traces = run_scenario(name)
+    scenario_dir = os.path.join(golden_dir, name)
+    by_name = dict((os.path.basename(t), t) for t in traces)
+    expected = GOLDEN[SCENARIOS[name][0]]
+    missing = [g for g in expected if g not in by_name]
+    if args[0] == "record":
+      if missing:
+        print("%s: FAIL, the run wrote no %s" % (name, " ".join(missing)))
+        failed += 1
+        continue
+      if os.path.isdir(scenario_dir):
+        shutil.rmtree(scenario_dir)
+      os.makedirs(scenario_dir)
+      for golden in expected:
+        shutil.copy(by_name[golden], scenario_dir)
+      print("%s: recorded %s" % (name, " ".join(expected)))
+      continue
+    mismatches = 0
+    for golden in expected:
+      golden_path = os.path.join(scenario_dir, golden)
+      if not os.path.isfile(golden_path):
+        print("  %s: no golden trace recorded (see golden/README.md)" % golden)
+        mismatches += 1
+      elif golden in missing:
+        print("  %s: not written by the run" % golden)
+        mismatches += 1
+      else:
+        mismatches += compare(golden_path, by_name[golden], time_tol, value_tol)
+    print("%s: %s" % (name, "FAIL" if mismatches else "ok"))
+    failed += mismatches > 0
+  return 1 if failed else 0
+
+
+if __name__ == "__main__":
+  sys.exit(main())
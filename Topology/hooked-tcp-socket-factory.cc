@@ -0,0 +1,48 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "hooked-tcp-socket-factory.h"
+#include "ns3/abort.h"
+#include "ns3/tcp-l4-protocol.h"
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (HookedTcpSocketFactory);
+
+TypeId
+HookedTcpSocketFactory::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::HookedTcpSocketFactory")
+    .SetParent<SocketFactory> ()
+    .AddConstructor<HookedTcpSocketFactory> ()
+    .AddTraceSource ("SocketCreated", "A socket has been created and is about to connect",
+                     MakeTraceSourceAccessor (&HookedTcpSocketFactory::m_socketCreatedTrace),
+                     "ns3::HookedTcpSocketFactory::SocketCreatedCallback")
+  ;
+  return tid;
+}
+
+Ptr<Socket>
+HookedTcpSocketFactory::CreateSocket (void)
+{
+  Ptr<TcpL4Protocol> tcp = GetObject<TcpL4Protocol> ();
+  NS_ABORT_MSG_UNLESS (tcp, "HookedTcpSocketFactory must be aggregated to a node with TCP");
+  Ptr<Socket> socket = tcp->CreateSocket ();
+  m_socketCreatedTrace (socket);
+  return socket;
+}
+
+} // namespace ns3
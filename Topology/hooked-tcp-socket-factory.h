@@ -0,0 +1,48 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef HOOKED_TCP_SOCKET_FACTORY_H
+#define HOOKED_TCP_SOCKET_FACTORY_H
+
+#include "ns3/socket.h"
+#include "ns3/socket-factory.h"
+#include "ns3/traced-callback.h"
+
+namespace ns3 {
+
+/**
+ * TCP socket factory of the ns-3 senders. It creates its sockets with the
+ * TcpL4Protocol of its node and fires SocketCreated before handing them to
+ * the application, i.e. before they bind and connect. This lets a stock
+ * BulkSendApplication get per-socket state: congestion control object, warm
+ * start, traces.
+ */
+class HookedTcpSocketFactory : public SocketFactory
+{
+public:
+  static TypeId GetTypeId (void);
+
+  virtual Ptr<Socket> CreateSocket (void);
+
+  typedef void (* SocketCreatedCallback)(Ptr<Socket> socket);
+
+private:
+  TracedCallback<Ptr<Socket> > m_socketCreatedTrace;
+};
+
+} // namespace ns3
+
+#endif /* HOOKED_TCP_SOCKET_FACTORY_H */
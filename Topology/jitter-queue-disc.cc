@@ -0,0 +1,122 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include "jitter-queue-disc.h"
+#include "ns3/drop-tail-queue.h"
+#include "ns3/object-factory.h"
+#include "ns3/simulator.h"
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (JitterQueueDisc);
+
+TypeId
+JitterQueueDisc::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::JitterQueueDisc")
+    .SetParent<QueueDisc> ()
+    .AddConstructor<JitterQueueDisc> ()
+    .AddAttribute ("MaxSize", "The max queue size",
+                   QueueSizeValue (QueueSize ("1000p")),
+                   MakeQueueSizeAccessor (&QueueDisc::SetMaxSize, &QueueDisc::GetMaxSize),
+                   MakeQueueSizeChecker ())
+    .AddAttribute ("Jitter", "Maximum extra delay of a packet",
+                   TimeValue (MilliSeconds (0)),
+                   MakeTimeAccessor (&JitterQueueDisc::m_jitter),
+                   MakeTimeChecker ())
+  ;
+  return tid;
+}
+
+JitterQueueDisc::JitterQueueDisc ()
+  : QueueDisc (QueueDiscSizePolicy::SINGLE_INTERNAL_QUEUE)
+{
+  m_ranvar = CreateObject<UniformRandomVariable> ();
+}
+
+int64_t
+JitterQueueDisc::AssignStreams (int64_t stream)
+{
+  m_ranvar->SetStream (stream);
+  return 1;
+}
+
+bool
+JitterQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
+{
+  if (GetCurrentSize () + item > GetMaxSize ())
+    {
+      DropBeforeEnqueue (item, "Queue disc limit exceeded");
+      return false;
+    }
+  if (!GetInternalQueue (0)->Enqueue (item))
+    {
+      return false;
+    }
+  Time release = Simulator::Now () + Seconds (m_ranvar->GetValue (0, m_jitter.GetSeconds ()));
+  m_lastRelease = std::max (m_lastRelease, release);
+  m_release.push_back (m_lastRelease);
+  return true;
+}
+
+Ptr<QueueDiscItem>
+JitterQueueDisc::DoDequeue (void)
+{
+  if (m_release.empty ())
+    {
+      return 0;
+    }
+  if (m_release.front () > Simulator::Now ())
+    {
+      if (!m_runEvent.IsRunning ())
+        {
+          m_runEvent = Simulator::Schedule (m_release.front () - Simulator::Now (), &QueueDisc::Run, this);
+        }
+      return 0;
+    }
+  m_release.pop_front ();
+  return GetInternalQueue (0)->Dequeue ();
+}
+
+bool
+JitterQueueDisc::CheckConfig (void)
+{
+  if (GetNQueueDiscClasses () > 0 || GetNPacketFilters () > 0)
+    {
+      return false;
+    }
+  if (GetNInternalQueues () == 0)
+    {
+      AddInternalQueue (CreateObjectWithAttributes<DropTailQueue<QueueDiscItem> >
+                          ("MaxSize", QueueSizeValue (GetMaxSize ())));
+    }
+  return GetNInternalQueues () == 1;
+}
+
+void
+JitterQueueDisc::InitializeParams (void)
+{
+}
+
+void
+JitterQueueDisc::DoDispose (void)
+{
+  m_runEvent.Cancel ();
+  QueueDisc::DoDispose ();
+}
+
+} // namespace ns3
@@ -0,0 +1,66 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef JITTER_QUEUE_DISC_H
+#define JITTER_QUEUE_DISC_H
+
+#include <deque>
+#include "ns3/queue-disc.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "ns3/random-variable-stream.h"
+
+namespace ns3 {
+
+/**
+ * FIFO queue disc adding a random delay, uniform in [0, Jitter], to every
+ * packet. A packet is never released before the packet ahead of it, so the
+ * jitter does not reorder packets, as on a real wireless link where the
+ * variable delay comes from link layer retries of a FIFO transmitter.
+ */
+class JitterQueueDisc : public QueueDisc
+{
+public:
+  static TypeId GetTypeId (void);
+
+  JitterQueueDisc ();
+
+  /**
+   * Assign a fixed random variable stream number to the random variable
+   * drawing the delays.
+   *
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned by this model
+   */
+  int64_t AssignStreams (int64_t stream);
+
+private:
+  virtual bool DoEnqueue (Ptr<QueueDiscItem> item);
+  virtual Ptr<QueueDiscItem> DoDequeue (void);
+  virtual bool CheckConfig (void);
+  virtual void InitializeParams (void);
+  virtual void DoDispose (void);
+
+  Time m_jitter;                      // Maximum extra delay of a packet
+  std::deque<Time> m_release;         // Release time of each queued packet, in order
+  Time m_lastRelease;                 // Release time of the last enqueued packet
+  EventId m_runEvent;                 // Restarts the queue disc when the head is released
+  Ptr<UniformRandomVariable> m_ranvar;
+};
+
+} // namespace ns3
+
+#endif /* JITTER_QUEUE_DISC_H */
@@ -0,0 +1,126 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include "live-publisher.h"
+#include "ns3/abort.h"
+#include "ns3/simulator.h"
+
+namespace ns3 {
+
+LivePublisher::LivePublisher (std::string path, Ptr<QueueDisc> queue, std::vector<std::string> flowNames,
+                              uint32_t segmentSize)
+  : m_queue (queue),
+    m_flowNames (flowNames),
+    m_segmentSize (segmentSize),
+    m_lastRxBytes (flowNames.size (), 0),
+    m_wallStart (std::chrono::steady_clock::now ()),
+    m_sent (0),
+    m_dropped (0)
+{
+  NS_ABORT_MSG_UNLESS (path.size () < sizeof (m_address.sun_path), "Live socket path " << path << " is too long");
+  m_fd = socket (AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+  NS_ABORT_MSG_UNLESS (m_fd >= 0, "Cannot create the live socket: " << strerror (errno));
+  memset (&m_address, 0, sizeof (m_address));
+  m_address.sun_family = AF_UNIX;
+  strncpy (m_address.sun_path, path.c_str (), sizeof (m_address.sun_path) - 1);
+}
+
+LivePublisher::~LivePublisher ()
+{
+  close (m_fd);
+}
+
+void
+LivePublisher::AddSource (Callback<void, LiveSnapshot &> source)
+{
+  m_sources.push_back (source);
+}
+
+void
+LivePublisher::Publish (Time interval)
+{
+  LiveSnapshot &snapshot = m_snapshot;
+  snapshot.queueDrops = 0;
+  snapshot.errorDrops = 0;
+  snapshot.marks = 0;
+  memset (snapshot.decisions, 0, sizeof (snapshot.decisions));
+  snapshot.rxBytes.assign (m_flowNames.size (), 0);
+  snapshot.cwnd.assign (m_flowNames.size (), -1);
+  for (Callback<void, LiveSnapshot &> &source : m_sources)
+    {
+      source (snapshot);
+    }
+
+  double elapsed = (Simulator::Now () - m_lastTime).GetSeconds ();
+  m_message.str ("");
+  m_message << "{\"time\":" << Simulator::Now ().GetSeconds ()
+            << ",\"wall\":" << std::chrono::duration<double> (std::chrono::steady_clock::now () - m_wallStart).count ()
+            << ",\"queue\":" << (m_queue ? static_cast<int64_t> (m_queue->GetCurrentSize ().GetValue ()) : -1)
+            << ",\"queueDrops\":" << snapshot.queueDrops
+            << ",\"errorDrops\":" << snapshot.errorDrops
+            << ",\"marks\":" << snapshot.marks
+            << ",\"randomAsRandom\":" << snapshot.decisions[0][0]
+            << ",\"randomAsCongestive\":" << snapshot.decisions[0][1]
+            << ",\"congestiveAsRandom\":" << snapshot.decisions[1][0]
+            << ",\"congestiveAsCongestive\":" << snapshot.decisions[1][1]
+            << ",\"flows\":[";
+  for (uint32_t flow = 0; flow < m_flowNames.size (); flow++)
+    {
+      uint64_t rxBytes = snapshot.rxBytes [flow];
+      double goodput = (elapsed > 0) ? (rxBytes - m_lastRxBytes [flow]) * 8.0 / elapsed / 1e6 : 0;
+      m_lastRxBytes [flow] = rxBytes;
+      m_message << (flow ? "," : "") << "{\"name\":\"" << m_flowNames [flow] << "\"";
+      // Only the ns-3 bulk senders trace their cwnd
+      if (snapshot.cwnd [flow] >= 0)
+        {
+          m_message << ",\"cwnd\":" << snapshot.cwnd [flow] / m_segmentSize;
+        }
+      m_message << ",\"goodput\":" << goodput << "}";
+    }
+  m_message << "]}";
+  m_lastTime = Simulator::Now ();
+
+  const std::string &message = m_message.str ();
+  if (sendto (m_fd, message.data (), message.size (), 0,
+              reinterpret_cast<struct sockaddr *> (&m_address), sizeof (m_address)) < 0)
+    {
+      // No viewer (ENOENT, ECONNREFUSED) or a full viewer buffer (EAGAIN)
+      m_dropped++;
+    }
+  else
+    {
+      m_sent++;
+    }
+  Simulator::Schedule (interval, &LivePublisher::Publish, this, interval);
+}
+
+uint64_t
+LivePublisher::GetSent (void) const
+{
+  return m_sent;
+}
+
+uint64_t
+LivePublisher::GetDropped (void) const
+{
+  return m_dropped;
+}
+
+} // namespace ns3
@@ -0,0 +1,85 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LIVE_PUBLISHER_H
+#define LIVE_PUBLISHER_H
+
+#include <sys/un.h>
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "ns3/callback.h"
+#include "ns3/nstime.h"
+#include "ns3/queue-disc.h"
+#include "ns3/simple-ref-count.h"
+
+namespace ns3 {
+
+// Counters of the run at one snapshot, filled by the sources of a LivePublisher
+struct LiveSnapshot
+{
+  uint64_t queueDrops;
+  uint64_t errorDrops;
+  uint64_t marks;
+  uint32_t decisions[2][2];               // Veno decisions, [truth congestive][decided congestive]
+  std::vector<uint64_t> rxBytes;          // Bytes received per flow
+  std::vector<int64_t> cwnd;              // cwnd per flow in bytes, -1 if not traced
+};
+
+/**
+ * Publishes a snapshot of the run every interval as a JSON datagram on a
+ * Unix socket bound by a viewer, e.g. live-viewer.py: per-flow cwnd and
+ * goodput, queue size, losses, marks and Veno classification counters.
+ * Sending never blocks; snapshots are dropped when no viewer listens or
+ * when it does not keep up.
+ */
+class LivePublisher : public SimpleRefCount<LivePublisher>
+{
+public:
+  LivePublisher (std::string path, Ptr<QueueDisc> queue, std::vector<std::string> flowNames,
+                 uint32_t segmentSize);
+  ~LivePublisher ();
+
+  // Adds a source of the counters of the snapshots; the counters a source
+  // does not fill stay at 0, and cwnd at -1
+  void AddSource (Callback<void, LiveSnapshot &> source);
+
+  // Sends a snapshot and schedules the next one
+  void Publish (Time interval);
+
+  uint64_t GetSent (void) const;
+  uint64_t GetDropped (void) const;
+
+private:
+  int m_fd;
+  struct sockaddr_un m_address;
+  Ptr<QueueDisc> m_queue;                 // Bottleneck queue, null if simulated by another rank
+  std::vector<std::string> m_flowNames;
+  double m_segmentSize;
+  std::vector<Callback<void, LiveSnapshot &> > m_sources;
+  LiveSnapshot m_snapshot;
+  std::vector<uint64_t> m_lastRxBytes;    // Bytes received per flow at the last snapshot
+  Time m_lastTime;
+  std::chrono::steady_clock::time_point m_wallStart;
+  std::ostringstream m_message;
+  uint64_t m_sent;
+  uint64_t m_dropped;
+};
+
+} // namespace ns3
+
+#endif /* LIVE_PUBLISHER_H */
@@ -0,0 +1,46 @@
+import json
+import os
+import socket
+import sys
+
+# Shows the live metrics of a running dumbbell simulation started with
+# --liveSocket=<path>, e.g.
+#
+#   python3 live-viewer.py /tmp/dumbbell.sock
+#   ./waf --run "dumbbelltopologyns3receiver --stack=ns3 --liveSocket=/tmp/dumbbell.sock"
+#
+# MPI ranks publish on <path>-rank<N>. Stop the viewer with Ctrl-C.
+
+path = sys.argv[1] if len(sys.argv) > 1 else "/tmp/dumbbell.sock"
+
+if os.path.exists(path):
+  os.unlink(path)
+sock = socket.socket(socket.AF_UNIX, socket.SOCK_DGRAM)
+sock.bind(path)
+print("Waiting for snapshots on " + path)
+
+try:
+  while True:
+    snapshot = json.loads(sock.recv(1 << 20).decode())
+    decided = [snapshot["randomAsRandom"], snapshot["randomAsCongestive"],
+               snapshot["congestiveAsRandom"], snapshot["congestiveAsCongestive"]]
+    correct = decided[0] + decided[3]
+    total = sum(decided)
+    lines = ["sim %.2fs  wall %.1fs (%.2f sim s/wall s)" % (snapshot["time"], snapshot["wall"],
+                                                            snapshot["time"] / max(snapshot["wall"], 1e-9)),
+             "queue %d pkts  queue drops %d  error drops %d  marks %d" % (snapshot["queue"], snapshot["queueDrops"],
+                                                                         snapshot["errorDrops"], snapshot["marks"]),
+             "loss classification %d/%d correct (random as congestive %d, congestive as random %d)"
+             % (correct, total, decided[1], decided[2]),
+             "%-6s %10s %14s" % ("flow", "cwnd(seg)", "goodput(Mbps)")]
+    for flow in snapshot["flows"]:
+      cwnd = "%.1f" % flow["cwnd"] if "cwnd" in flow else "-"
+      lines.append("%-6s %10s %14.3f" % (flow["name"], cwnd, flow["goodput"]))
+    # Redraw in place
+    sys.stdout.write("\033[H\033[J" + "\n".join(lines) + "\n")
+    sys.stdout.flush()
+except KeyboardInterrupt:
+  pass
+finally:
+  sock.close()
+  os.unlink(path)
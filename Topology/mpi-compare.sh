@@ -0,0 +1,36 @@
+#!/bin/sh
+# Runs the same ns-3 scenario serially and over 2 and 4 MPI ranks, checks
+# that the distributed runs write the same cwnd and ssthresh traces as the
+# serial one, and prints the Simulator::Run wall-clock time and speedup of
+# every run. Run it from the ns-3-dce directory, built with --enable-mpi;
+# extra arguments are passed to every run, e.g. ./mpi-compare.sh --nSenders=64
+
+results=results/dumbbell-topology
+table=$results/mpi-compare.txt
+args="dumbbelltopologyns3receiver --stack=ns3 --pcap=false --stream=1 --nSenders=32 $*"
+echo "ranks lookahead(s) wallClock(s) speedup traces" > $table
+
+./waf --run "$args" || exit 1
+serial=$(ls -td $results/*/ | head -1)
+serialTime=$(awk '$1 == "wallClock(s)" { print $2 }' $serial/runTime.txt)
+echo "1 - $serialTime 1 reference" >> $table
+# Each run writes its results to a new timestamp directory
+sleep 1
+
+for ranks in 2 4
+do
+  mpirun -np $ranks ./waf --run "$args --mpi=true" || exit 1
+  run=$(ls -td $results/*/ | head -1)
+  # The ranks run in lockstep, the slowest one gives the run time
+  runTime=$(cat $run/runTime-rank*.txt | awk '$1 == "wallClock(s)" && $2 > max { max = $2 } END { print max }')
+  lookahead=$(awk '$1 == "lookahead(s)" { print $2 }' $run/runTime-rank0.txt)
+  if diff -r $serial/cwndTraces $run/cwndTraces > /dev/null
+  then
+    traces=identical
+  else
+    traces=different
+  fi
+  echo "$ranks $lookahead $runTime $(echo "$serialTime / $runTime" | bc -l) $traces" >> $table
+  sleep 1
+done
+column -t $table
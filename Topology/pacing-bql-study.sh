@@ -0,0 +1,18 @@
+#!/bin/sh
+# Runs the dumbbell topology with TcpVeno, pacing on and off crossed with
+# BQL on and off, and prints the drop rate, queue occupancy percentiles and
+# goodput of the four runs. Run it from the ns-3-dce directory; extra
+# arguments are passed to every run, e.g. ./pacing-bql-study.sh --nSenders=4
+
+table=results/dumbbell-topology/pacing-bql-study.txt
+rm -f $table
+for pacing in false true
+do
+  for bql in false true
+  do
+    ./waf --run "dumbbelltopologyns3receiver --stack=ns3 --transport_prot=TcpVeno --pacing=$pacing --BQL=$bql --studyFile=$table $*" || exit 1
+    # Each run writes its results to a new timestamp directory
+    sleep 1
+  done
+done
+column -t $table
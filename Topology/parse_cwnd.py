@@ -36,6 +36,7 @@ for i in sender_node_id:
   in_filepath = "../results/dumbbell-topology/cwnd_data/"+str(i)
   all_sockets = get_sockets(in_filepath)
   write_mode = 'w'
+  ssthresh_mode = 'w'
   for socket in all_sockets:
     time_found = 0
     cwnd_found = 0
@@ -56,6 +57,11 @@ for i in sender_node_id:
         if port_found:
           with open("../results/dumbbell-topology/cwnd_data/"+ chr(i+63) + "-linux.plotme", write_mode) as out_file:
             out_file.write(str(time_format) + " " + str(cwnd) + "\n")
+          if "ssthresh:" in info:
+            ssthresh = info.split("ssthresh:")[1].split()[0]
+            with open("../results/dumbbell-topology/cwnd_data/"+ chr(i+63) + "-linux-ssthresh.plotme", ssthresh_mode) as out_file:
+              out_file.write(str(time_format) + " " + str(ssthresh) + "\n")
+            ssthresh_mode = 'a'
           write_mode = 'a'
           port_found = 0
  
@@ -0,0 +1,546 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Reconstructs the TCP flows of pcap files, such as the ones written by the
+ * dumbbell topology under pcap/Linux* and pcap/ns-3*, in a single pass over
+ * the memory-mapped file. For every flow (direction carrying data) it writes
+ * the time series of:
+ *
+ *   goodput   Mbps of newly acknowledged bytes, per --interval seconds
+ *   rtt       RTT samples in ms, from TSval/TSecr or, without timestamps,
+ *             from the segments acknowledged for the first time (Karn)
+ *   inflight  bytes sent but not yet acknowledged, in packets of --mss bytes
+ *   retrans   cumulative number of retransmitted segments
+ *
+ * as "<time> <value>" plotme files, or as pairs of native doubles with
+ * --binary. Files are processed in parallel.
+ *
+ * Build: g++ -O2 -std=c++11 -pthread pcap-flow-analyzer.cc -o pcap-flow-analyzer
+ * Usage: pcap-flow-analyzer [--interval=0.1] [--mss=524] [--jobs=N] [--binary]
+ *                           [--out=dir] file.pcap...
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+struct Options
+{
+  double interval = 0.1;
+  uint32_t mss = 524;
+  unsigned jobs = 0;
+  bool binary = false;
+  std::string out = ".";
+};
+
+// A time series written to one output file
+struct Series
+{
+  std::vector<std::pair<double, double> > points;
+
+  void Add (double time, double value)
+  {
+    points.push_back (std::make_pair (time, value));
+  }
+};
+
+// State of one direction of a TCP connection
+struct Direction
+{
+  bool seen = false;
+  uint32_t isn = 0;            // First sequence number seen
+  uint64_t highSeq = 0;        // End of the highest byte sent, relative to isn
+  uint64_t highAck = 0;        // Highest cumulative ACK received, relative to isn
+  bool acked = false;          // At least one ACK received
+  uint64_t binBytes = 0;       // Bytes acknowledged in the current goodput bin
+  double binStart = -1;        // Start of the current goodput bin
+  uint64_t retransmissions = 0;
+  std::unordered_map<uint32_t, double> tsvalTimes; // TSval -> first time sent
+  std::deque<std::tuple<uint64_t, double, bool> > unacked; // Segment end, time sent, retransmitted
+
+  Series goodput, rtt, inflight, retrans;
+};
+
+// Unwraps a 32 bit sequence number relative to isn, given a nearby 64 bit value
+uint64_t
+Unwrap (uint32_t seq, uint32_t isn, uint64_t near)
+{
+  uint32_t rel = seq - isn;
+  int32_t delta = static_cast<int32_t> (rel - static_cast<uint32_t> (near));
+  int64_t value = static_cast<int64_t> (near) + delta;
+  return value < 0 ? 0 : static_cast<uint64_t> (value);
+}
+
+uint16_t
+Get16 (const uint8_t *p)
+{
+  return (p[0] << 8) | p[1];
+}
+
+uint32_t
+Get32 (const uint8_t *p)
+{
+  return (static_cast<uint32_t> (p[0]) << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+std::string
+Endpoint (uint32_t address, uint16_t port)
+{
+  std::ostringstream os;
+  os << (address >> 24) << "." << ((address >> 16) & 0xff) << "."
+     << ((address >> 8) & 0xff) << "." << (address & 0xff) << "." << port;
+  return os.str ();
+}
+
+class FlowAnalyzer
+{
+public:
+  explicit FlowAnalyzer (const Options &options)
+    : m_options (options)
+  {
+  }
+
+  // Processes one IPv4 packet captured at the given time
+  void Packet (double time, const uint8_t *ip, uint32_t length);
+
+  // Writes the series of all the flows, named after the given prefix
+  void Write (const std::string &prefix);
+
+private:
+  typedef std::tuple<uint32_t, uint16_t, uint32_t, uint16_t> Key;
+
+  // reverse is null until a packet was seen in the reverse direction
+  void Segment (double time, Direction &data, Direction *reverse,
+                uint32_t seq, uint32_t ack, bool ackFlag, uint32_t payload,
+                bool hasTs, uint32_t tsval, uint32_t tsecr);
+  void CloseBin (Direction &d, double time);
+
+  const Options &m_options;
+  std::map<Key, Direction> m_directions;
+};
+
+void
+FlowAnalyzer::Packet (double time, const uint8_t *ip, uint32_t length)
+{
+  if (length < 20 || (ip[0] >> 4) != 4 || ip[9] != 6)
+    {
+      return;
+    }
+  uint32_t ipHeader = (ip[0] & 0x0f) * 4;
+  uint32_t totalLength = Get16 (ip + 2);
+  if (length < ipHeader + 20 || totalLength < ipHeader + 20)
+    {
+      return;
+    }
+  const uint8_t *tcp = ip + ipHeader;
+  uint32_t tcpHeader = (tcp[12] >> 4) * 4;
+  if (tcpHeader < 20 || totalLength < ipHeader + tcpHeader || length < ipHeader + tcpHeader)
+    {
+      return;
+    }
+
+  uint32_t src = Get32 (ip + 12);
+  uint32_t dst = Get32 (ip + 16);
+  uint16_t sport = Get16 (tcp);
+  uint16_t dport = Get16 (tcp + 2);
+  uint32_t seq = Get32 (tcp + 4);
+  uint32_t ack = Get32 (tcp + 8);
+  uint8_t flags = tcp[13];
+  // The payload length comes from the IPv4 header, so truncated
+  // (header-only) captures are analyzed as well as full ones
+  uint32_t payload = totalLength - ipHeader - tcpHeader;
+
+  // Timestamp option
+  bool hasTs = false;
+  uint32_t tsval = 0;
+  uint32_t tsecr = 0;
+  for (uint32_t i = 20; i < tcpHeader; )
+    {
+      uint8_t kind = tcp[i];
+      if (kind == 0)
+        {
+          break;
+        }
+      if (kind == 1)
+        {
+          i++;
+          continue;
+        }
+      if (i + 1 >= tcpHeader || tcp[i + 1] < 2)
+        {
+          break;
+        }
+      if (kind == 8 && tcp[i + 1] == 10 && i + 10 <= tcpHeader)
+        {
+          hasTs = true;
+          tsval = Get32 (tcp + i + 2);
+          tsecr = Get32 (tcp + i + 6);
+        }
+      i += tcp[i + 1];
+    }
+
+  Direction &data = m_directions[Key (src, sport, dst, dport)];
+  auto reverseIt = m_directions.find (Key (dst, dport, src, sport));
+  Direction *reverse = (reverseIt != m_directions.end ()) ? &reverseIt->second : nullptr;
+  if (!data.seen)
+    {
+      data.seen = true;
+      // The SYN consumes one sequence number
+      data.isn = seq + ((flags & 0x02) ? 1 : 0);
+    }
+  Segment (time, data, reverse, seq, ack,
+           (flags & 0x10) != 0, payload, hasTs, tsval, tsecr);
+}
+
+void
+FlowAnalyzer::CloseBin (Direction &d, double time)
+{
+  while (time >= d.binStart + m_options.interval)
+    {
+      d.goodput.Add (d.binStart + m_options.interval,
+                     d.binBytes * 8.0 / m_options.interval / 1e6);
+      d.binBytes = 0;
+      d.binStart += m_options.interval;
+    }
+}
+
+void
+FlowAnalyzer::Segment (double time, Direction &data, Direction *reverseDirection,
+                       uint32_t seq, uint32_t ack, bool ackFlag, uint32_t payload,
+                       bool hasTs, uint32_t tsval, uint32_t tsecr)
+{
+  // Data sent in this direction
+  if (payload > 0)
+    {
+      uint64_t start = Unwrap (seq, data.isn, data.highSeq);
+      uint64_t end = start + payload;
+      bool retransmitted = start < data.highSeq;
+      if (retransmitted)
+        {
+          data.retransmissions++;
+          data.retrans.Add (time, data.retransmissions);
+          for (auto &segment : data.unacked)
+            {
+              if (std::get<0> (segment) > start && std::get<0> (segment) <= end)
+                {
+                  std::get<2> (segment) = true;
+                }
+            }
+        }
+      if (end > data.highSeq)
+        {
+          data.highSeq = end;
+          data.unacked.push_back (std::make_tuple (end, time, retransmitted));
+        }
+      if (hasTs && data.tsvalTimes.find (tsval) == data.tsvalTimes.end ())
+        {
+          data.tsvalTimes[tsval] = time;
+        }
+      data.inflight.Add (time, (data.highSeq - data.highAck) / static_cast<double> (m_options.mss));
+    }
+
+  // ACK of the data sent in the reverse direction
+  if (!ackFlag || !reverseDirection || !reverseDirection->seen)
+    {
+      return;
+    }
+  Direction &reverse = *reverseDirection;
+  uint64_t acked = Unwrap (ack, reverse.isn, reverse.highAck);
+  if (!reverse.acked)
+    {
+      reverse.acked = true;
+      reverse.binStart = time;
+    }
+  if (acked <= reverse.highAck || acked > reverse.highSeq)
+    {
+      return;
+    }
+
+  CloseBin (reverse, time);
+  reverse.binBytes += acked - reverse.highAck;
+  reverse.highAck = acked;
+
+  bool sampled = false;
+  if (hasTs)
+    {
+      auto it = reverse.tsvalTimes.find (tsecr);
+      if (it != reverse.tsvalTimes.end ())
+        {
+          reverse.rtt.Add (time, (time - it->second) * 1000);
+          sampled = true;
+          // Older timestamps will not be echoed any more
+          for (auto old = reverse.tsvalTimes.begin (); old != reverse.tsvalTimes.end (); )
+            {
+              old = (static_cast<int32_t> (old->first - tsecr) <= 0) ? reverse.tsvalTimes.erase (old) : std::next (old);
+            }
+        }
+    }
+  double lastSent = -1;
+  bool lastRetransmitted = true;
+  while (!reverse.unacked.empty () && std::get<0> (reverse.unacked.front ()) <= acked)
+    {
+      lastSent = std::get<1> (reverse.unacked.front ());
+      lastRetransmitted = std::get<2> (reverse.unacked.front ());
+      reverse.unacked.pop_front ();
+    }
+  if (!sampled && lastSent >= 0 && !lastRetransmitted)
+    {
+      reverse.rtt.Add (time, (time - lastSent) * 1000);
+    }
+  reverse.inflight.Add (time, (reverse.highSeq - reverse.highAck) / static_cast<double> (m_options.mss));
+}
+
+void
+WriteSeries (const Series &series, const std::string &fileName, bool binary)
+{
+  FILE *file = fopen (fileName.c_str (), binary ? "wb" : "w");
+  if (!file)
+    {
+      std::cerr << "Cannot write " << fileName << std::endl;
+      return;
+    }
+  if (binary)
+    {
+      for (const auto &point : series.points)
+        {
+          double record[2] = {point.first, point.second};
+          fwrite (record, sizeof (double), 2, file);
+        }
+    }
+  else
+    {
+      for (const auto &point : series.points)
+        {
+          fprintf (file, "%.6f %g\n", point.first, point.second);
+        }
+    }
+  fclose (file);
+}
+
+void
+FlowAnalyzer::Write (const std::string &prefix)
+{
+  for (auto &entry : m_directions)
+    {
+      Direction &d = entry.second;
+      if (d.highSeq == 0)
+        {
+          continue;   // Pure ACK direction
+        }
+      if (d.binStart >= 0)
+        {
+          CloseBin (d, d.binStart + m_options.interval);
+        }
+      std::string flow = prefix + "-" + Endpoint (std::get<0> (entry.first), std::get<1> (entry.first))
+        + "-" + Endpoint (std::get<2> (entry.first), std::get<3> (entry.first));
+      std::string extension = m_options.binary ? ".bin" : ".plotme";
+      WriteSeries (d.goodput, flow + "-goodput" + extension, m_options.binary);
+      WriteSeries (d.rtt, flow + "-rtt" + extension, m_options.binary);
+      WriteSeries (d.inflight, flow + "-inflight" + extension, m_options.binary);
+      WriteSeries (d.retrans, flow + "-retrans" + extension, m_options.binary);
+    }
+}
+
+// Reads one pcap file and writes the series of its flows; returns false on error
+bool
+AnalyzeFile (const std::string &fileName, const Options &options)
+{
+  int fd = open (fileName.c_str (), O_RDONLY);
+  if (fd < 0)
+    {
+      std::cerr << "Cannot open " << fileName << std::endl;
+      return false;
+    }
+  struct stat st;
+  if (fstat (fd, &st) != 0 || st.st_size < 24)
+    {
+      std::cerr << fileName << " is not a pcap file" << std::endl;
+      close (fd);
+      return false;
+    }
+  size_t size = st.st_size;
+  void *map = mmap (0, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close (fd);
+  if (map == MAP_FAILED)
+    {
+      std::cerr << "Cannot map " << fileName << std::endl;
+      return false;
+    }
+  madvise (map, size, MADV_SEQUENTIAL);
+  const uint8_t *base = static_cast<const uint8_t *> (map);
+
+  uint32_t magic;
+  memcpy (&magic, base, 4);
+  bool swapped = (magic == 0xd4c3b2a1 || magic == 0x4d3cb2a1);
+  bool nanoseconds = (magic == 0xa1b23c4d || magic == 0x4d3cb2a1);
+  if (!swapped && magic != 0xa1b2c3d4 && magic != 0xa1b23c4d)
+    {
+      std::cerr << fileName << " is not a pcap file" << std::endl;
+      munmap (map, size);
+      return false;
+    }
+  auto read32 = [swapped] (const uint8_t *p) {
+      uint32_t v;
+      memcpy (&v, p, 4);
+      return swapped ? __builtin_bswap32 (v) : v;
+    };
+  uint32_t linkType = read32 (base + 20);
+
+  FlowAnalyzer analyzer (options);
+  size_t offset = 24;
+  while (offset + 16 <= size)
+    {
+      const uint8_t *record = base + offset;
+      double time = read32 (record) + read32 (record + 4) / (nanoseconds ? 1e9 : 1e6);
+      uint32_t capLen = read32 (record + 8);
+      offset += 16;
+      if (offset + capLen > size)
+        {
+          break;
+        }
+      const uint8_t *frame = base + offset;
+      offset += capLen;
+
+      // Skip the link layer header
+      uint32_t skip = 0;
+      bool ipv4 = false;
+      switch (linkType)
+        {
+        case 9:     // PPP, as written by ns-3 point to point devices
+          ipv4 = capLen >= 2 && Get16 (frame) == 0x0021;
+          skip = 2;
+          break;
+        case 1:     // Ethernet
+          ipv4 = capLen >= 14 && Get16 (frame + 12) == 0x0800;
+          skip = 14;
+          break;
+        case 113:   // Linux cooked capture
+          ipv4 = capLen >= 16 && Get16 (frame + 14) == 0x0800;
+          skip = 16;
+          break;
+        case 101:   // Raw IP
+        case 228:
+          ipv4 = true;
+          break;
+        default:
+          break;
+        }
+      if (ipv4 && capLen > skip)
+        {
+          analyzer.Packet (time, frame + skip, capLen - skip);
+        }
+    }
+  munmap (map, size);
+
+  std::string name = fileName.substr (fileName.find_last_of ('/') + 1);
+  if (name.size () > 5 && name.compare (name.size () - 5, 5, ".pcap") == 0)
+    {
+      name.resize (name.size () - 5);
+    }
+  analyzer.Write (options.out + "/" + name);
+  return true;
+}
+
+} // namespace
+
+int
+main (int argc, char *argv[])
+{
+  Options options;
+  std::vector<std::string> files;
+  for (int i = 1; i < argc; i++)
+    {
+      std::string arg (argv[i]);
+      if (arg.compare (0, 11, "--interval=") == 0)
+        {
+          options.interval = atof (arg.c_str () + 11);
+        }
+      else if (arg.compare (0, 6, "--mss=") == 0)
+        {
+          options.mss = atoi (arg.c_str () + 6);
+        }
+      else if (arg.compare (0, 7, "--jobs=") == 0)
+        {
+          options.jobs = atoi (arg.c_str () + 7);
+        }
+      else if (arg == "--binary")
+        {
+          options.binary = true;
+        }
+      else if (arg.compare (0, 6, "--out=") == 0)
+        {
+          options.out = arg.substr (6);
+        }
+      else if (arg.compare (0, 2, "--") == 0)
+        {
+          std::cerr << "Usage: " << argv[0] << " [--interval=0.1] [--mss=524] [--jobs=N] "
+                    << "[--binary] [--out=dir] file.pcap..." << std::endl;
+          return 1;
+        }
+      else
+        {
+          files.push_back (arg);
+        }
+    }
+  if (options.interval <= 0 || options.mss == 0)
+    {
+      std::cerr << "--interval and --mss must be positive" << std::endl;
+      return 1;
+    }
+
+  unsigned jobs = options.jobs ? options.jobs : std::max (1u, std::thread::hardware_concurrency ());
+  std::atomic<size_t> next (0);
+  std::atomic<bool> failed (false);
+  std::vector<std::thread> workers;
+  for (unsigned j = 0; j < std::min<size_t> (jobs, files.size ()); j++)
+    {
+      workers.push_back (std::thread ([&] () {
+          for (size_t f = next++; f < files.size (); f = next++)
+            {
+              if (!AnalyzeFile (files[f], options))
+                {
+                  failed = true;
+                }
+            }
+        }));
+    }
+  for (auto &worker : workers)
+    {
+      worker.join ();
+    }
+  return failed ? 1 : 0;
+}
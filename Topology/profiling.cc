@@ -0,0 +1,156 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "profiling.h"
+#include "ns3/simulator.h"
+
+namespace ns3 {
+
+bool Profiler::s_enabled = false;
+ProfileCounter Profiler::s_counters[PROFILE_CATEGORIES];
+double Profiler::s_childSeconds = 0;
+std::chrono::steady_clock::time_point Profiler::s_wallStart;
+std::vector<ProfileSample> Profiler::s_samples;
+
+void
+Profiler::Enable (void)
+{
+  s_enabled = true;
+}
+
+const char *
+Profiler::GetName (ProfileCategory category)
+{
+  static const char *names[PROFILE_CATEGORIES] = {"queuePolling", "ssStats", "traceCallbacks", "pcapCapture", "congestionOps"};
+  return names [category];
+}
+
+const ProfileCounter &
+Profiler::GetCounter (ProfileCategory category)
+{
+  return s_counters [category];
+}
+
+void
+Profiler::StartSampling (Time interval)
+{
+  s_wallStart = std::chrono::steady_clock::now ();
+  Simulator::ScheduleNow (&Profiler::Sample, interval);
+}
+
+const std::vector<ProfileSample> &
+Profiler::GetSamples (void)
+{
+  return s_samples;
+}
+
+void
+Profiler::Sample (Time interval)
+{
+  ProfileSample sample;
+  sample.simTime = Simulator::Now ().GetSeconds ();
+  sample.wallTime = std::chrono::duration<double> (std::chrono::steady_clock::now () - s_wallStart).count ();
+  sample.events = Simulator::GetEventCount ();
+  s_samples.push_back (sample);
+  Simulator::Schedule (interval, &Profiler::Sample, interval);
+}
+
+NS_OBJECT_ENSURE_REGISTERED (ProfiledCongestionOps);
+
+TypeId
+ProfiledCongestionOps::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::ProfiledCongestionOps")
+    .SetParent<TcpCongestionOps> ()
+  ;
+  return tid;
+}
+
+ProfiledCongestionOps::ProfiledCongestionOps (Ptr<TcpCongestionOps> ops)
+  : m_ops (ops)
+{
+}
+
+Ptr<TcpCongestionOps>
+ProfiledCongestionOps::Wrap (Ptr<TcpCongestionOps> ops)
+{
+  if (!Profiler::IsEnabled ())
+    {
+      return ops;
+    }
+  return CreateObject<ProfiledCongestionOps> (ops);
+}
+
+std::string
+ProfiledCongestionOps::GetName () const
+{
+  return m_ops->GetName ();
+}
+
+uint32_t
+ProfiledCongestionOps::GetSsThresh (Ptr<const TcpSocketState> tcb, uint32_t bytesInFlight)
+{
+  ProfileScope scope (PROFILE_CONGESTION_OPS);
+  return m_ops->GetSsThresh (tcb, bytesInFlight);
+}
+
+void
+ProfiledCongestionOps::IncreaseWindow (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked)
+{
+  ProfileScope scope (PROFILE_CONGESTION_OPS);
+  m_ops->IncreaseWindow (tcb, segmentsAcked);
+}
+
+void
+ProfiledCongestionOps::PktsAcked (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked, const Time& rtt)
+{
+  ProfileScope scope (PROFILE_CONGESTION_OPS);
+  m_ops->PktsAcked (tcb, segmentsAcked, rtt);
+}
+
+void
+ProfiledCongestionOps::CongestionStateSet (Ptr<TcpSocketState> tcb, const TcpSocketState::TcpCongState_t newState)
+{
+  ProfileScope scope (PROFILE_CONGESTION_OPS);
+  m_ops->CongestionStateSet (tcb, newState);
+}
+
+void
+ProfiledCongestionOps::CwndEvent (Ptr<TcpSocketState> tcb, const TcpSocketState::TcpCAEvent_t event)
+{
+  ProfileScope scope (PROFILE_CONGESTION_OPS);
+  m_ops->CwndEvent (tcb, event);
+}
+
+void
+ProfiledCongestionOps::SerializeState (std::ostream &os) const
+{
+  m_ops->SerializeState (os);
+}
+
+void
+ProfiledCongestionOps::DeserializeState (std::istream &is)
+{
+  m_ops->DeserializeState (is);
+}
+
+Ptr<TcpCongestionOps>
+ProfiledCongestionOps::Fork ()
+{
+  return CreateObject<ProfiledCongestionOps> (m_ops->Fork ());
+}
+
+} // namespace ns3
@@ -0,0 +1,151 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PROFILING_H
+#define PROFILING_H
+
+#include <chrono>
+#include <vector>
+#include "ns3/nstime.h"
+#include "ns3/tcp-congestion-ops.h"
+
+namespace ns3 {
+
+// Categories of the events scheduled by the dumbbell example
+enum ProfileCategory
+{
+  PROFILE_QUEUE_POLLING,
+  PROFILE_SS_STATS,
+  PROFILE_TRACES,
+  PROFILE_PCAP,
+  PROFILE_CONGESTION_OPS,
+  PROFILE_CATEGORIES
+};
+
+struct ProfileCounter
+{
+  uint64_t calls = 0;
+  double seconds = 0;
+};
+
+// Simulated time, wall-clock time and event count at one sampling instant
+struct ProfileSample
+{
+  double simTime;
+  double wallTime;
+  uint64_t events;
+};
+
+/**
+ * Opt-in profiling of the events scheduled by the example. The wall time
+ * of a scope excludes the scopes nested in it, e.g. a cwnd trace fired
+ * from within a congestion control call. The profiler is process-wide,
+ * like the simulator: the modules open their scopes without being handed
+ * a profiler, and pay a single test when profiling is off.
+ */
+class Profiler
+{
+public:
+  static void Enable (void);
+  static bool IsEnabled (void)
+  {
+    return s_enabled;
+  }
+
+  static const char *GetName (ProfileCategory category);
+  static const ProfileCounter &GetCounter (ProfileCategory category);
+
+  // Records the simulation speed every interval, from now on
+  static void StartSampling (Time interval);
+  static const std::vector<ProfileSample> &GetSamples (void);
+
+private:
+  friend class ProfileScope;
+
+  static void Sample (Time interval);
+
+  static bool s_enabled;
+  static ProfileCounter s_counters[PROFILE_CATEGORIES];
+  static double s_childSeconds;     // Wall time of the scopes nested in the current one
+  static std::chrono::steady_clock::time_point s_wallStart;
+  static std::vector<ProfileSample> s_samples;
+};
+
+// Accounts the wall time until the end of the enclosing block to a category
+class ProfileScope
+{
+public:
+  explicit ProfileScope (ProfileCategory category)
+    : m_category (category),
+      m_enabled (Profiler::s_enabled)
+  {
+    if (m_enabled)
+      {
+        m_savedChildSeconds = Profiler::s_childSeconds;
+        Profiler::s_childSeconds = 0;
+        m_start = std::chrono::steady_clock::now ();
+      }
+  }
+
+  ~ProfileScope ()
+  {
+    if (m_enabled)
+      {
+        double elapsed = std::chrono::duration<double> (std::chrono::steady_clock::now () - m_start).count ();
+        Profiler::s_counters [m_category].calls++;
+        Profiler::s_counters [m_category].seconds += elapsed - Profiler::s_childSeconds;
+        Profiler::s_childSeconds = m_savedChildSeconds + elapsed;
+      }
+  }
+
+private:
+  ProfileCategory m_category;
+  bool m_enabled;
+  double m_savedChildSeconds = 0;
+  std::chrono::steady_clock::time_point m_start;
+};
+
+/**
+ * Forwards every call to the congestion control object of a sender and
+ * accounts for the wall time spent in it.
+ */
+class ProfiledCongestionOps : public TcpCongestionOps
+{
+public:
+  static TypeId GetTypeId (void);
+
+  ProfiledCongestionOps (Ptr<TcpCongestionOps> ops);
+
+  // Returns ops wrapped in a ProfiledCongestionOps when profiling, ops otherwise
+  static Ptr<TcpCongestionOps> Wrap (Ptr<TcpCongestionOps> ops);
+
+  virtual std::string GetName () const;
+  virtual uint32_t GetSsThresh (Ptr<const TcpSocketState> tcb, uint32_t bytesInFlight);
+  virtual void IncreaseWindow (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked);
+  virtual void PktsAcked (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked, const Time& rtt);
+  virtual void CongestionStateSet (Ptr<TcpSocketState> tcb, const TcpSocketState::TcpCongState_t newState);
+  virtual void CwndEvent (Ptr<TcpSocketState> tcb, const TcpSocketState::TcpCAEvent_t event);
+  virtual void SerializeState (std::ostream &os) const;
+  virtual void DeserializeState (std::istream &is);
+  virtual Ptr<TcpCongestionOps> Fork ();
+
+private:
+  Ptr<TcpCongestionOps> m_ops;
+};
+
+} // namespace ns3
+
+#endif /* PROFILING_H */
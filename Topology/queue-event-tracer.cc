@@ -0,0 +1,126 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <fstream>
+#include "queue-event-tracer.h"
+#include "profiling.h"
+#include "ns3/abort.h"
+#include "ns3/ipv4-queue-disc-item.h"
+#include "ns3/simulator.h"
+
+namespace ns3 {
+
+QueueEventTracer::QueueEventTracer (std::string prefix, Ptr<QueueDisc> queue,
+                                    const std::map<uint32_t, uint32_t> &flowByAddress, uint32_t nFlows)
+  : m_queue (queue),
+    m_flowByAddress (flowByAddress),
+    m_records (BUFFER_RECORDS),
+    m_count (0),
+    m_flowDrops (nFlows, 0),
+    m_flowMarks (nFlows, 0)
+{
+  m_dropFile = fopen ((prefix + "drop-0.plotme").c_str (), "w");
+  m_markFile = fopen ((prefix + "mark-0.plotme").c_str (), "w");
+  m_eventFile = fopen ((prefix + "events-0.txt").c_str (), "w");
+  NS_ABORT_MSG_UNLESS (m_dropFile && m_markFile && m_eventFile, "Cannot create the queue traces in " << prefix);
+}
+
+QueueEventTracer::~QueueEventTracer ()
+{
+  Flush ();
+  fclose (m_dropFile);
+  fclose (m_markFile);
+  fclose (m_eventFile);
+}
+
+void
+QueueEventTracer::Add (Ptr<const QueueDiscItem> item, bool mark)
+{
+  ProfileScope scope (PROFILE_TRACES);
+  Record &record = m_records [m_count++];
+  record.time = Simulator::Now ().GetSeconds ();
+  record.flow = -1;
+  record.mark = mark;
+  record.queueLength = m_queue->GetCurrentSize ().GetValue ();
+  Ptr<const Ipv4QueueDiscItem> ipv4Item = DynamicCast<const Ipv4QueueDiscItem> (item);
+  if (ipv4Item)
+    {
+      auto it = m_flowByAddress.find (ipv4Item->GetHeader ().GetSource ().Get ());
+      if (it != m_flowByAddress.end ())
+        {
+          record.flow = it->second;
+          (mark ? m_flowMarks : m_flowDrops) [it->second]++;
+        }
+    }
+  if (m_count == BUFFER_RECORDS)
+    {
+      Flush ();
+    }
+}
+
+void
+QueueEventTracer::Drop (Ptr<const QueueDiscItem> item)
+{
+  Add (item, false);
+}
+
+void
+QueueEventTracer::Mark (Ptr<const QueueDiscItem> item, const char *reason)
+{
+  Add (item, true);
+}
+
+void
+QueueEventTracer::Flush (void)
+{
+  std::string drops;
+  std::string marks;
+  std::string events;
+  char line[64];
+  for (uint32_t i = 0; i < m_count; i++)
+    {
+      const Record &record = m_records [i];
+      snprintf (line, sizeof (line), "%g 1\n", record.time);
+      (record.mark ? marks : drops) += line;
+      snprintf (line, sizeof (line), "%g %d %s %u\n", record.time, record.flow,
+                record.mark ? "mark" : "drop", record.queueLength);
+      events += line;
+    }
+  fwrite (drops.data (), 1, drops.size (), m_dropFile);
+  fwrite (marks.data (), 1, marks.size (), m_markFile);
+  fwrite (events.data (), 1, events.size (), m_eventFile);
+  m_count = 0;
+}
+
+void
+QueueEventTracer::WriteFlowCounts (std::string fileName, const std::vector<std::string> &flowNames) const
+{
+  std::ofstream os (fileName.c_str (), std::ios::out | std::ios::trunc);
+  os << "# flow drops marks\n";
+  for (uint32_t flow = 0; flow < m_flowDrops.size (); flow++)
+    {
+      os << flowNames [flow] << " " << m_flowDrops [flow] << " " << m_flowMarks [flow] << "\n";
+    }
+  os.close ();
+}
+
+uint64_t
+QueueEventTracer::GetFlowDrops (uint32_t flow) const
+{
+  return m_flowDrops [flow];
+}
+
+} // namespace ns3
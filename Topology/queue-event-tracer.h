@@ -0,0 +1,81 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef QUEUE_EVENT_TRACER_H
+#define QUEUE_EVENT_TRACER_H
+
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+#include "ns3/queue-disc.h"
+#include "ns3/simple-ref-count.h"
+
+namespace ns3 {
+
+/**
+ * Records the drops and ECN marks of a queue disc, with the flow of the
+ * packet and the queue length, in a preallocated buffer written to disk in
+ * blocks. Writes drop-<n>.plotme and mark-<n>.plotme ("<time> 1" lines) and
+ * events-<n>.txt ("<time> <flow> <drop|mark> <queue length>" lines), and
+ * counts the drops and marks of every flow.
+ */
+class QueueEventTracer : public SimpleRefCount<QueueEventTracer>
+{
+public:
+  QueueEventTracer (std::string prefix, Ptr<QueueDisc> queue,
+                    const std::map<uint32_t, uint32_t> &flowByAddress, uint32_t nFlows);
+  ~QueueEventTracer ();
+
+  // Trace sinks of the Drop and Mark traces of the queue disc
+  void Drop (Ptr<const QueueDiscItem> item);
+  void Mark (Ptr<const QueueDiscItem> item, const char *reason);
+
+  // Writes the buffered records to disk
+  void Flush (void);
+
+  // Writes the drops and marks of every flow
+  void WriteFlowCounts (std::string fileName, const std::vector<std::string> &flowNames) const;
+
+  uint64_t GetFlowDrops (uint32_t flow) const;
+
+private:
+  static const uint32_t BUFFER_RECORDS = 1 << 16;
+
+  struct Record
+  {
+    double time;
+    int32_t flow;                     // -1 if the source address is not a sender
+    bool mark;
+    uint32_t queueLength;
+  };
+
+  void Add (Ptr<const QueueDiscItem> item, bool mark);
+
+  Ptr<QueueDisc> m_queue;
+  std::map<uint32_t, uint32_t> m_flowByAddress;
+  std::vector<Record> m_records;
+  uint32_t m_count;
+  std::vector<uint64_t> m_flowDrops;
+  std::vector<uint64_t> m_flowMarks;
+  FILE *m_dropFile;
+  FILE *m_markFile;
+  FILE *m_eventFile;
+};
+
+} // namespace ns3
+
+#endif /* QUEUE_EVENT_TRACER_H */
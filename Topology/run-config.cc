@@ -0,0 +1,181 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <fstream>
+#include <sstream>
+#include "run-config.h"
+#include "ns3/abort.h"
+#include "ns3/data-rate.h"
+#include "ns3/nstime.h"
+#include "ns3/queue-size.h"
+
+namespace ns3 {
+
+// Kind of value of a config key, checked when the file is loaded
+enum ConfigValueKind
+{
+  CONFIG_ANY,
+  CONFIG_RATE,
+  CONFIG_TIME,
+  CONFIG_QUEUE_SIZE
+};
+
+struct ConfigKey
+{
+  const char *section;
+  const char *key;
+  const char *option;               // Command line option set by the key
+  ConfigValueKind kind;
+};
+
+const ConfigKey configKeys[] = {
+  {"topology", "nSenders", "nSenders", CONFIG_ANY},
+  {"topology", "stack", "stack", CONFIG_ANY},
+  {"topology", "flowStacks", "flowStacks", CONFIG_ANY},
+  {"bottleneck", "rate", "bottleneckRate", CONFIG_RATE},
+  {"bottleneck", "delay", "bottleneckDelay", CONFIG_TIME},
+  {"access", "rate", "accessRate", CONFIG_RATE},
+  {"access", "delay", "accessDelay", CONFIG_TIME},
+  {"access", "receiverDelay", "receiverDelay", CONFIG_TIME},
+  {"queue", "type", "queue_disc_type", CONFIG_ANY},
+  {"queue", "size", "queueSize", CONFIG_QUEUE_SIZE},
+  {"queue", "BQL", "BQL", CONFIG_ANY},
+  {"queue", "ecn", "ecn", CONFIG_ANY},
+  {"tcp", "transport_prot", "transport_prot", CONFIG_ANY},
+  {"tcp", "linux_prot", "linux_prot", CONFIG_ANY},
+  {"tcp", "recovery", "recovery", CONFIG_ANY},
+  {"tcp", "segmentSize", "dataSize", CONFIG_ANY},
+  {"tcp", "initialCwnd", "initialCwnd", CONFIG_ANY},
+  {"tcp", "sndBufSize", "sndBufSize", CONFIG_ANY},
+  {"tcp", "rcvBufSize", "rcvBufSize", CONFIG_ANY},
+  {"tcp", "delAckCount", "delAckCount", CONFIG_ANY},
+  {"tcp", "Sack", "Sack", CONFIG_ANY},
+  {"tcp", "WindowScaling", "WindowScaling", CONFIG_ANY},
+  {"tcp", "HyStart", "HyStart", CONFIG_ANY},
+};
+
+static bool
+IsValidConfigValue (ConfigValueKind kind, std::string value)
+{
+  if (kind == CONFIG_RATE)
+    {
+      DataRateValue rate;
+      return rate.DeserializeFromString (value, MakeDataRateChecker ());
+    }
+  if (kind == CONFIG_TIME)
+    {
+      TimeValue time;
+      return time.DeserializeFromString (value, MakeTimeChecker ());
+    }
+  if (kind == CONFIG_QUEUE_SIZE)
+    {
+      QueueSizeValue size;
+      return size.DeserializeFromString (value, MakeQueueSizeChecker ());
+    }
+  return !value.empty ();
+}
+
+static std::string
+Trim (std::string text)
+{
+  size_t begin = text.find_first_not_of (" \t\r");
+  size_t end = text.find_last_not_of (" \t\r");
+  return (begin == std::string::npos) ? "" : text.substr (begin, end - begin + 1);
+}
+
+RunConfig
+LoadRunConfig (std::string fileName)
+{
+  std::ifstream is (fileName.c_str ());
+  NS_ABORT_MSG_UNLESS (is.is_open (), "Cannot open config file " << fileName);
+
+  RunConfig config;
+  std::string section;
+  int32_t flow = -1;
+  std::string line;
+  for (uint32_t lineNumber = 1; std::getline (is, line); lineNumber++)
+    {
+      line = Trim (line.substr (0, line.find ('#')));
+      if (line.empty ())
+        {
+          continue;
+        }
+      std::ostringstream where;
+      where << fileName << ":" << lineNumber << ": ";
+
+      if (line [0] == '[')
+        {
+          NS_ABORT_MSG_UNLESS (line [line.size () - 1] == ']', where.str () << "unterminated section header");
+          section = Trim (line.substr (1, line.size () - 2));
+          flow = -1;
+          if (section.compare (0, 5, "flow ") == 0)
+            {
+              std::string name = Trim (section.substr (5));
+              if (name.size () == 1 && name [0] >= 'A' && name [0] <= 'Z')
+                {
+                  flow = name [0] - 'A';
+                }
+              else if (!name.empty () && name.find_first_not_of ("0123456789") == std::string::npos)
+                {
+                  flow = std::stoi (name);
+                }
+              NS_ABORT_MSG_IF (flow < 0, where.str () << "unknown flow " << name);
+              config.flows [flow];
+              continue;
+            }
+          NS_ABORT_MSG_UNLESS (section == "topology" || section == "bottleneck" || section == "access"
+                               || section == "queue" || section == "tcp" || section == "options",
+                               where.str () << "unknown section [" << section << "]");
+          continue;
+        }
+
+      size_t equal = line.find ('=');
+      NS_ABORT_MSG_IF (equal == std::string::npos, where.str () << "expected key = value");
+      std::string key = Trim (line.substr (0, equal));
+      std::string value = Trim (line.substr (equal + 1));
+      NS_ABORT_MSG_IF (key.empty () || value.empty (), where.str () << "expected key = value");
+      NS_ABORT_MSG_IF (section.empty (), where.str () << key << " is outside of a section");
+
+      if (flow >= 0)
+        {
+          ConfigValueKind kind = (key == "accessDelay") ? CONFIG_TIME : CONFIG_ANY;
+          NS_ABORT_MSG_UNLESS (key == "protocol" || key == "accessDelay" || key == "stack",
+                               where.str () << "unknown flow key " << key);
+          NS_ABORT_MSG_UNLESS (IsValidConfigValue (kind, value), where.str () << "invalid " << key << " " << value);
+          config.flows [flow][key] = value;
+          continue;
+        }
+      if (section == "options")
+        {
+          config.args.push_back ("--" + key + "=" + value);
+          continue;
+        }
+      const ConfigKey *match = 0;
+      for (const ConfigKey &configKey : configKeys)
+        {
+          if (section == configKey.section && key == configKey.key)
+            {
+              match = &configKey;
+            }
+        }
+      NS_ABORT_MSG_UNLESS (match, where.str () << "unknown key " << key << " in [" << section << "]");
+      NS_ABORT_MSG_UNLESS (IsValidConfigValue (match->kind, value), where.str () << "invalid " << key << " " << value);
+      config.args.push_back (std::string ("--") + match->option + "=" + value);
+    }
+  return config;
+}
+
+} // namespace ns3
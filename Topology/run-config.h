@@ -0,0 +1,45 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef RUN_CONFIG_H
+#define RUN_CONFIG_H
+
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+// Run description loaded with --config=<file>. The file holds "key = value"
+// lines under [section] headers; '#' starts a comment. [topology],
+// [bottleneck], [access], [queue] and [tcp] take the keys of configKeys in
+// run-config.cc, [options] any command line option, and [flow <X>] (X being
+// the flow name, A, B, ..., or its index) the protocol, accessDelay and
+// stack of a single flow. Options given on the command line override the
+// file.
+struct RunConfig
+{
+  std::vector<std::string> args;    // Options of the file, as --name=value
+  std::map<uint32_t, std::map<std::string, std::string> > flows;  // Parameters of single flows
+};
+
+// Loads a run description; aborts on the first invalid line
+RunConfig LoadRunConfig (std::string fileName);
+
+} // namespace ns3
+
+#endif /* RUN_CONFIG_H */
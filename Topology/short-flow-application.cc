@@ -0,0 +1,420 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <fstream>
+#include "short-flow-application.h"
+#include "ns3/abort.h"
+#include "ns3/double.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/tcp-socket-factory.h"
+#include "ns3/uinteger.h"
+
+namespace ns3 {
+
+FlowSizeCdf::FlowSizeCdf (std::string name)
+{
+  // Sizes in packets of 1460 bytes
+  static const double webSearch[][2] = {{6, 0}, {6, 0.15}, {13, 0.2}, {19, 0.3}, {33, 0.4}, {53, 0.53},
+                                        {133, 0.6}, {667, 0.7}, {1333, 0.8}, {3333, 0.9}, {6667, 0.97}, {20000, 1}};
+  static const double dataMining[][2] = {{1, 0}, {1, 0.5}, {2, 0.6}, {3, 0.7}, {7, 0.8}, {267, 0.9},
+                                         {2107, 0.95}, {66667, 0.99}, {666667, 1}};
+  if (name == "websearch")
+    {
+      for (const auto &point : webSearch)
+        {
+          m_points.push_back (std::make_pair (point[0] * 1460, point[1]));
+        }
+    }
+  else if (name == "datamining")
+    {
+      for (const auto &point : dataMining)
+        {
+          m_points.push_back (std::make_pair (point[0] * 1460, point[1]));
+        }
+    }
+  else
+    {
+      std::ifstream is (name.c_str ());
+      NS_ABORT_MSG_UNLESS (is.is_open (), "Cannot open flow size distribution " << name);
+      double size, probability;
+      while (is >> size >> probability)
+        {
+          NS_ABORT_MSG_UNLESS (m_points.empty () || (size >= m_points.back ().first && probability >= m_points.back ().second),
+                               "Flow size distribution " << name << " is not increasing");
+          m_points.push_back (std::make_pair (size, probability));
+        }
+    }
+  NS_ABORT_MSG_UNLESS (!m_points.empty () && m_points.back ().second == 1,
+                       "Flow size distribution " << name << " does not end at probability 1");
+}
+
+uint64_t
+FlowSizeCdf::GetSize (double quantile) const
+{
+  for (uint32_t i = 0; i < m_points.size (); i++)
+    {
+      if (m_points [i].second >= quantile)
+        {
+          if (i == 0 || m_points [i].second == m_points [i - 1].second)
+            {
+              return std::max<uint64_t> (1, m_points [i].first);
+            }
+          double fraction = (quantile - m_points [i - 1].second) / (m_points [i].second - m_points [i - 1].second);
+          return std::max<uint64_t> (1, m_points [i - 1].first + fraction * (m_points [i].first - m_points [i - 1].first));
+        }
+    }
+  return m_points.back ().first;
+}
+
+double
+FlowSizeCdf::GetMean (void) const
+{
+  double mean = m_points.front ().first * m_points.front ().second;
+  for (uint32_t i = 1; i < m_points.size (); i++)
+    {
+      mean += (m_points [i].second - m_points [i - 1].second) * (m_points [i].first + m_points [i - 1].first) / 2;
+    }
+  return mean;
+}
+
+NS_OBJECT_ENSURE_REGISTERED (ShortFlowApplication);
+
+TypeId
+ShortFlowApplication::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::ShortFlowApplication")
+    .SetParent<Application> ()
+    .AddConstructor<ShortFlowApplication> ()
+    .AddAttribute ("SendSize", "The amount of data to send each time.",
+                   UintegerValue (512),
+                   MakeUintegerAccessor (&ShortFlowApplication::m_sendSize),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("Remote", "The address of the destination",
+                   AddressValue (),
+                   MakeAddressAccessor (&ShortFlowApplication::m_peer),
+                   MakeAddressChecker ())
+    .AddAttribute ("Protocol", "The type of protocol to use.",
+                   TypeIdValue (TcpSocketFactory::GetTypeId ()),
+                   MakeTypeIdAccessor (&ShortFlowApplication::m_tid),
+                   MakeTypeIdChecker ())
+    .AddAttribute ("ArrivalRate", "Mean number of flows started per second",
+                   DoubleValue (1),
+                   MakeDoubleAccessor (&ShortFlowApplication::m_arrivalRate),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("MaxFlows", "The number of flows to start (0 means no limit)",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&ShortFlowApplication::m_maxFlows),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddTraceSource ("SocketCreated", "A socket has been created and is about to connect",
+                     MakeTraceSourceAccessor (&ShortFlowApplication::m_socketCreatedTrace),
+                     "ns3::HookedTcpSocketFactory::SocketCreatedCallback")
+    .AddTraceSource ("FlowEnded", "A flow has completed, failed or been censored and its state released",
+                     MakeTraceSourceAccessor (&ShortFlowApplication::m_flowEndedTrace),
+                     "ns3::HookedTcpSocketFactory::SocketCreatedCallback")
+    .AddTraceSource ("FlowCompleted", "All the bytes of a flow have been acknowledged",
+                     MakeTraceSourceAccessor (&ShortFlowApplication::m_flowCompletedTrace),
+                     "ns3::ShortFlowApplication::FlowCompletedCallback")
+    .AddTraceSource ("FlowFailed", "The connection of a flow failed or was reset",
+                     MakeTraceSourceAccessor (&ShortFlowApplication::m_flowFailedTrace),
+                     "ns3::ShortFlowApplication::FlowCompletedCallback")
+    .AddTraceSource ("FlowCensored", "A flow was still in progress when the application stopped",
+                     MakeTraceSourceAccessor (&ShortFlowApplication::m_flowCensoredTrace),
+                     "ns3::ShortFlowApplication::FlowCompletedCallback")
+  ;
+  return tid;
+}
+
+ShortFlowApplication::ShortFlowApplication ()
+  : m_started (0)
+{
+  m_size = CreateObject<UniformRandomVariable> ();
+  m_interArrival = CreateObject<ExponentialRandomVariable> ();
+}
+
+void
+ShortFlowApplication::SetFlowSizeCdf (const FlowSizeCdf &cdf)
+{
+  m_cdf.reset (new FlowSizeCdf (cdf));
+}
+
+int64_t
+ShortFlowApplication::AssignStreams (int64_t stream)
+{
+  m_size->SetStream (stream);
+  m_interArrival->SetStream (stream + 1);
+  return 2;
+}
+
+size_t
+ShortFlowApplication::GetOpenFlows () const
+{
+  return m_flows.size ();
+}
+
+void
+ShortFlowApplication::StartApplication (void)
+{
+  NS_ABORT_MSG_UNLESS (m_cdf, "ShortFlowApplication has no flow size distribution");
+  if (m_arrivalRate > 0)
+    {
+      m_nextFlow = Simulator::Schedule (Seconds (m_interArrival->GetValue (1 / m_arrivalRate, 0)),
+                                        &ShortFlowApplication::StartFlow, this);
+    }
+}
+
+void
+ShortFlowApplication::StopApplication (void)
+{
+  m_nextFlow.Cancel ();
+  while (!m_flows.empty ())
+    {
+      auto it = m_flows.begin ();
+      m_flowCensoredTrace (it->second.size, Simulator::Now () - it->second.start);
+      EndFlow (it);
+    }
+}
+
+void
+ShortFlowApplication::StartFlow (void)
+{
+  Flow flow;
+  flow.socket = Socket::CreateSocket (GetNode (), m_tid);
+  flow.size = m_cdf->GetSize (m_size->GetValue ());
+  flow.sent = 0;
+  flow.start = Simulator::Now ();
+  flow.connected = false;
+  m_socketCreatedTrace (flow.socket);
+  UintegerValue sndBufSize;
+  flow.socket->GetAttribute ("SndBufSize", sndBufSize);
+  flow.sndBufSize = sndBufSize.Get ();
+  flow.socket->Bind ();
+  flow.socket->Connect (m_peer);
+  flow.socket->ShutdownRecv ();
+  flow.socket->SetConnectCallback (MakeCallback (&ShortFlowApplication::ConnectionSucceeded, this),
+                                   MakeCallback (&ShortFlowApplication::ConnectionFailed, this));
+  flow.socket->SetSendCallback (MakeCallback (&ShortFlowApplication::DataSend, this));
+  flow.socket->SetCloseCallbacks (MakeNullCallback<void, Ptr<Socket> > (),
+                                  MakeCallback (&ShortFlowApplication::ConnectionFailed, this));
+  m_flows [PeekPointer (flow.socket)] = flow;
+
+  m_started++;
+  if (m_maxFlows == 0 || m_started < m_maxFlows)
+    {
+      m_nextFlow = Simulator::Schedule (Seconds (m_interArrival->GetValue (1 / m_arrivalRate, 0)),
+                                        &ShortFlowApplication::StartFlow, this);
+    }
+}
+
+// Closes the socket of a flow and releases everything the flow holds: its
+// entry, and the callbacks through which the socket refers to the
+// application. The socket itself stays with TCP until TIME_WAIT is over.
+void
+ShortFlowApplication::EndFlow (std::unordered_map<Socket *, Flow>::iterator it)
+{
+  Ptr<Socket> socket = it->second.socket;
+  m_flows.erase (it);
+  socket->SetConnectCallback (MakeNullCallback<void, Ptr<Socket> > (),
+                              MakeNullCallback<void, Ptr<Socket> > ());
+  socket->SetSendCallback (MakeNullCallback<void, Ptr<Socket>, uint32_t> ());
+  socket->SetCloseCallbacks (MakeNullCallback<void, Ptr<Socket> > (),
+                             MakeNullCallback<void, Ptr<Socket> > ());
+  socket->Close ();
+  m_flowEndedTrace (socket);
+}
+
+void
+ShortFlowApplication::SendData (Flow &flow)
+{
+  while (flow.sent < flow.size)
+    {
+      uint64_t toSend = std::min<uint64_t> (m_sendSize, flow.size - flow.sent);
+      int actual = flow.socket->Send (Create<Packet> (toSend));
+      if (actual > 0)
+        {
+          flow.sent += actual;
+        }
+      if ((unsigned) actual != toSend)
+        {
+          break;
+        }
+    }
+}
+
+void
+ShortFlowApplication::ConnectionSucceeded (Ptr<Socket> socket)
+{
+  auto it = m_flows.find (PeekPointer (socket));
+  if (it != m_flows.end ())
+    {
+      it->second.connected = true;
+      SendData (it->second);
+    }
+}
+
+void
+ShortFlowApplication::ConnectionFailed (Ptr<Socket> socket)
+{
+  auto it = m_flows.find (PeekPointer (socket));
+  if (it != m_flows.end ())
+    {
+      m_flowFailedTrace (it->second.size, Simulator::Now () - it->second.start);
+      EndFlow (it);
+    }
+}
+
+void
+ShortFlowApplication::DataSend (Ptr<Socket> socket, uint32_t available)
+{
+  auto it = m_flows.find (PeekPointer (socket));
+  if (it == m_flows.end () || !it->second.connected)
+    {
+      return;
+    }
+  Flow &flow = it->second;
+  if (flow.sent < flow.size)
+    {
+      SendData (flow);
+    }
+  else if (socket->GetTxAvailable () == flow.sndBufSize)
+    {
+      m_flowCompletedTrace (flow.size, Simulator::Now () - flow.start);
+      EndFlow (it);
+    }
+}
+
+NS_OBJECT_ENSURE_REGISTERED (ShortFlowSink);
+
+TypeId
+ShortFlowSink::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::ShortFlowSink")
+    .SetParent<Application> ()
+    .AddConstructor<ShortFlowSink> ()
+    .AddAttribute ("Local", "The Address on which to Bind the rx socket.",
+                   AddressValue (),
+                   MakeAddressAccessor (&ShortFlowSink::m_local),
+                   MakeAddressChecker ())
+    .AddAttribute ("Protocol", "The type id of the protocol to use for the rx socket.",
+                   TypeIdValue (TcpSocketFactory::GetTypeId ()),
+                   MakeTypeIdAccessor (&ShortFlowSink::m_tid),
+                   MakeTypeIdChecker ())
+    .AddTraceSource ("Rx", "A packet has been received",
+                     MakeTraceSourceAccessor (&ShortFlowSink::m_rxTrace),
+                     "ns3::Packet::AddressTracedCallback")
+  ;
+  return tid;
+}
+
+ShortFlowSink::ShortFlowSink ()
+  : m_totalRx (0)
+{
+}
+
+uint64_t
+ShortFlowSink::GetTotalRx () const
+{
+  return m_totalRx;
+}
+
+size_t
+ShortFlowSink::GetOpenSockets () const
+{
+  return m_sockets.size ();
+}
+
+void
+ShortFlowSink::StartApplication (void)
+{
+  m_socket = Socket::CreateSocket (GetNode (), m_tid);
+  if (m_socket->Bind (m_local) == -1)
+    {
+      NS_FATAL_ERROR ("Failed to bind socket");
+    }
+  m_socket->Listen ();
+  m_socket->SetAcceptCallback (MakeNullCallback<bool, Ptr<Socket>, const Address &> (),
+                               MakeCallback (&ShortFlowSink::HandleAccept, this));
+}
+
+void
+ShortFlowSink::StopApplication (void)
+{
+  for (Ptr<Socket> socket : m_sockets)
+    {
+      socket->Close ();
+    }
+  m_sockets.clear ();
+  if (m_socket)
+    {
+      m_socket->Close ();
+      m_socket->SetAcceptCallback (MakeNullCallback<bool, Ptr<Socket>, const Address &> (),
+                                   MakeNullCallback<void, Ptr<Socket>, const Address &> ());
+    }
+}
+
+void
+ShortFlowSink::HandleAccept (Ptr<Socket> socket, const Address& from)
+{
+  socket->SetRecvCallback (MakeCallback (&ShortFlowSink::HandleRead, this));
+  socket->SetCloseCallbacks (MakeCallback (&ShortFlowSink::HandlePeerClose, this),
+                             MakeCallback (&ShortFlowSink::HandlePeerError, this));
+  m_sockets.insert (socket);
+}
+
+void
+ShortFlowSink::HandleRead (Ptr<Socket> socket)
+{
+  Ptr<Packet> packet;
+  Address from;
+  while ((packet = socket->RecvFrom (from)))
+    {
+      if (packet->GetSize () == 0)
+        {
+          break;
+        }
+      m_totalRx += packet->GetSize ();
+      m_rxTrace (packet, from);
+    }
+}
+
+// The peer sent its FIN: answer with ours, the TCP socket goes away once
+// it is acknowledged
+void
+ShortFlowSink::HandlePeerClose (Ptr<Socket> socket)
+{
+  socket->Close ();
+  ReleaseSocket (socket);
+}
+
+void
+ShortFlowSink::HandlePeerError (Ptr<Socket> socket)
+{
+  ReleaseSocket (socket);
+}
+
+// Forgets a socket whose flow is over, together with the callbacks through
+// which it refers to the sink
+void
+ShortFlowSink::ReleaseSocket (Ptr<Socket> socket)
+{
+  socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+  socket->SetCloseCallbacks (MakeNullCallback<void, Ptr<Socket> > (),
+                             MakeNullCallback<void, Ptr<Socket> > ());
+  m_sockets.erase (socket);
+}
+
+} // namespace ns3
@@ -0,0 +1,172 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SHORT_FLOW_APPLICATION_H
+#define SHORT_FLOW_APPLICATION_H
+
+#include <memory>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "ns3/address.h"
+#include "ns3/application.h"
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/socket.h"
+#include "ns3/traced-callback.h"
+
+namespace ns3 {
+
+/**
+ * Cumulative distribution of flow sizes, sampled with linear interpolation
+ * between its points. "websearch" and "datamining" are the distributions
+ * measured in the DCTCP and VL2 papers; any other name is read from a file
+ * of "<size in bytes> <cumulative probability>" lines.
+ */
+class FlowSizeCdf
+{
+public:
+  explicit FlowSizeCdf (std::string name);
+
+  // Returns the flow size, in bytes, at the given quantile
+  uint64_t GetSize (double quantile) const;
+
+  // Returns the mean flow size, in bytes
+  double GetMean (void) const;
+
+private:
+  std::vector<std::pair<double, double> > m_points;
+};
+
+/**
+ * Opens flows of random sizes to one destination with Poisson arrivals.
+ * A single application handles all the flows of a node; a flow completes
+ * when all its bytes are acknowledged, i.e. when the send buffer is empty
+ * again, and its socket is then closed. A flow whose connection fails or
+ * is reset is reported as failed, and the flows still in progress when the
+ * application stops as censored.
+ */
+class ShortFlowApplication : public Application
+{
+public:
+  static TypeId GetTypeId (void);
+
+  ShortFlowApplication ();
+
+  // Sets the distribution the flow sizes are drawn from
+  void SetFlowSizeCdf (const FlowSizeCdf &cdf);
+
+  /**
+   * Assign fixed random variable streams
+   *
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned
+   */
+  int64_t AssignStreams (int64_t stream);
+
+  // Returns the number of flows in progress, i.e. whose state is held
+  size_t GetOpenFlows () const;
+
+  /**
+   * TracedCallback signature for the completion of a flow
+   *
+   * \param size the size of the flow in bytes
+   * \param fct the flow completion time
+   */
+  typedef void (* FlowCompletedCallback)(uint64_t size, Time fct);
+
+private:
+  // State of one flow
+  struct Flow
+  {
+    Ptr<Socket> socket;
+    uint64_t size;
+    uint64_t sent;
+    Time start;
+    uint32_t sndBufSize;              // Send buffer size, free again once all is acknowledged
+    bool connected;
+  };
+
+  virtual void StartApplication (void);
+  virtual void StopApplication (void);
+
+  void StartFlow (void);
+  void EndFlow (std::unordered_map<Socket *, Flow>::iterator it);
+  void SendData (Flow &flow);
+  void ConnectionSucceeded (Ptr<Socket> socket);
+  void ConnectionFailed (Ptr<Socket> socket);
+  void DataSend (Ptr<Socket> socket, uint32_t available);
+
+  Address m_peer;                     // Peer address
+  TypeId m_tid;                       // The type of protocol to use
+  uint32_t m_sendSize;                // Size of data to send each time
+  double m_arrivalRate;               // Flows started per second
+  uint32_t m_maxFlows;                // Number of flows to start (0 means no limit)
+  uint32_t m_started;                 // Flows started so far
+  std::unique_ptr<FlowSizeCdf> m_cdf; // Flow size distribution
+  std::unordered_map<Socket *, Flow> m_flows; // Flows in progress
+  EventId m_nextFlow;                 // Start of the next flow
+  Ptr<UniformRandomVariable> m_size;
+  Ptr<ExponentialRandomVariable> m_interArrival;
+  TracedCallback<Ptr<Socket> > m_socketCreatedTrace;
+  TracedCallback<Ptr<Socket> > m_flowEndedTrace;
+  TracedCallback<uint64_t, Time> m_flowCompletedTrace;
+  TracedCallback<uint64_t, Time> m_flowFailedTrace;
+  TracedCallback<uint64_t, Time> m_flowCensoredTrace;
+};
+
+/**
+ * Receives the short flows. Unlike PacketSink, which keeps every accepted
+ * socket until the end of the run, it closes a socket when the peer closes
+ * the flow and then releases it.
+ */
+class ShortFlowSink : public Application
+{
+public:
+  static TypeId GetTypeId (void);
+
+  ShortFlowSink ();
+
+  // Returns the total bytes received
+  uint64_t GetTotalRx () const;
+
+  // Returns the number of accepted sockets whose flow is still open
+  size_t GetOpenSockets () const;
+
+private:
+  virtual void StartApplication (void);
+  virtual void StopApplication (void);
+
+  void HandleAccept (Ptr<Socket> socket, const Address& from);
+  void HandleRead (Ptr<Socket> socket);
+  void HandlePeerClose (Ptr<Socket> socket);
+  void HandlePeerError (Ptr<Socket> socket);
+  void ReleaseSocket (Ptr<Socket> socket);
+
+  Address m_local;                    // Local address to bind to
+  TypeId m_tid;                       // Protocol TypeId
+  uint64_t m_totalRx;                 // Total bytes received
+  Ptr<Socket> m_socket;               // Listening socket
+  std::set<Ptr<Socket> > m_sockets;   // Accepted sockets of the open flows
+  TracedCallback<Ptr<const Packet>, const Address &> m_rxTrace;
+};
+
+} // namespace ns3
+
+#endif /* SHORT_FLOW_APPLICATION_H */
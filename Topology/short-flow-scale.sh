@@ -0,0 +1,18 @@
+#!/bin/sh
+# Runs the short flow workload with 100000 flows (4 senders x 25000) of 1 to
+# 10 KB on a 1 Gbps bottleneck, and prints the peak resident memory and wall
+# time of the run together with the peak per-flow state of shortFlowState.plotme.
+# Run it from the ns-3-dce directory; extra arguments are passed to the run,
+# e.g. ./short-flow-scale.sh --shortFlowMax=50000 for 200000 flows
+
+results=results/dumbbell-topology
+cdf=$results/short-flow-scale.cdf
+mkdir -p $results
+printf "1000 0\n10000 1\n" > $cdf
+./waf --command-template="/usr/bin/time -v -o $results/short-flow-scale.time %s" \
+  --run "dumbbelltopologyns3receiver --stack=ns3 --transport_prot=TcpNewReno --pcap=false --nSenders=4 --shortFlows=true --shortFlowCdf=$cdf --shortFlowMax=25000 --bottleneckRate=1Gbps --accessRate=1Gbps --stopTime=100 $*" || exit 1
+run=$(ls -td $results/*/ | head -1)
+awk -F': ' '/Maximum resident set size/ { print "peakRss(KB) " $2 } /Elapsed \(wall clock\)/ { print "wallTime " $2 }' $results/short-flow-scale.time
+awk '$1 == "#" { next } { for (i = 2; i <= 5; i++) if ($i > peak [i]) peak [i] = $i }
+     END { print "peakSenderFlows " peak [2]; print "peakTracedFlows " peak [3]; print "peakSinkSockets " peak [4]; print "peakTcpSockets " peak [5] }' $run/shortFlowState.plotme
+grep -v '^#' $run/fctStats.txt
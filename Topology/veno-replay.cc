@@ -0,0 +1,210 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Replays the TcpVeno sample streams of a run (venoSamples/<X>-ns3.bin) and
+ * recomputes Veno's backlog estimate under other baseRtt rules and betas,
+ * without simulating again. For every file, rule and beta it prints the
+ * congestion avoidance samples, the share of them with diff >= beta (cwnd
+ * growing every other RTT) and the mean diff. The agreement column compares
+ * the recomputed decisions at the beta of the sender with the recorded
+ * ones; it is close to 100% with the recorded rule, the RTTs being stored
+ * in microseconds.
+ *
+ * Build: g++ -O2 -std=c++11 veno-replay.cc -o veno-replay
+ * Usage: veno-replay [--beta=1,2,3,6] [--baseRtt=recorded,min,window:10,fixed:22]
+ *                    [--series=dir] file.bin...
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "veno-samples.h"
+
+using namespace venosamples;
+
+namespace {
+
+std::vector<std::string>
+SplitList (const std::string &list)
+{
+  std::vector<std::string> items;
+  std::istringstream is (list);
+  std::string item;
+  while (std::getline (is, item, ','))
+    {
+      if (!item.empty ())
+        {
+          items.push_back (item);
+        }
+    }
+  return items;
+}
+
+std::string
+BaseName (const std::string &path)
+{
+  size_t slash = path.rfind ('/');
+  std::string name = (slash == std::string::npos) ? path : path.substr (slash + 1);
+  size_t dot = name.rfind ('.');
+  return (dot == std::string::npos) ? name : name.substr (0, dot);
+}
+
+// Writes "<time> <diff>" for the congestion avoidance records
+bool
+WriteSeries (const std::string &path, const std::vector<Record> &records, const std::vector<uint32_t> &diffs)
+{
+  FILE *file = fopen (path.c_str (), "w");
+  if (!file)
+    {
+      return false;
+    }
+  for (size_t i = 0; i < records.size (); i++)
+    {
+      if (IsCongestionAvoidance (records[i]))
+        {
+          fprintf (file, "%.6f %u\n", records[i].time, diffs[i]);
+        }
+    }
+  fclose (file);
+  return true;
+}
+
+const char *modeNames[] = {"all", "downsample", "reservoir"};
+
+} // namespace
+
+int
+main (int argc, char *argv[])
+{
+  std::vector<std::string> betas;
+  std::vector<std::string> rules = {"recorded"};
+  std::string series;
+  std::vector<std::string> files;
+  for (int i = 1; i < argc; i++)
+    {
+      std::string arg (argv[i]);
+      if (arg.compare (0, 7, "--beta=") == 0)
+        {
+          betas = SplitList (arg.substr (7));
+        }
+      else if (arg.compare (0, 10, "--baseRtt=") == 0)
+        {
+          rules = SplitList (arg.substr (10));
+        }
+      else if (arg.compare (0, 9, "--series=") == 0)
+        {
+          series = arg.substr (9);
+        }
+      else if (arg.compare (0, 2, "--") == 0)
+        {
+          std::cerr << "Usage: " << argv[0] << " [--beta=1,2,3,6] [--baseRtt=recorded,min,window:<s>,fixed:<ms>] "
+                    << "[--series=dir] file.bin..." << std::endl;
+          return 1;
+        }
+      else
+        {
+          files.push_back (arg);
+        }
+    }
+
+  std::vector<BaseRttRule> parsedRules;
+  for (const std::string &text : rules)
+    {
+      BaseRttRule rule;
+      if (!ParseBaseRttRule (text, rule))
+        {
+          std::cerr << "Unknown baseRtt rule " << text << std::endl;
+          return 1;
+        }
+      parsedRules.push_back (rule);
+    }
+
+  bool failed = false;
+  printf ("# file baseRtt beta samples fullyUtilized(%%) meanDiff agreement(%%)\n");
+  for (const std::string &path : files)
+    {
+      FileHeader header;
+      std::vector<Record> records;
+      std::string error;
+      if (!ReadFile (path, header, records, error))
+        {
+          std::cerr << error << std::endl;
+          failed = true;
+          continue;
+        }
+      printf ("# %s: %llu of %llu samples (%s), sender beta %u\n", path.c_str (),
+              static_cast<unsigned long long> (header.records), static_cast<unsigned long long> (header.offered),
+              header.mode < 3 ? modeNames[header.mode] : "?", header.beta);
+
+      std::vector<uint32_t> fileBetas;
+      for (const std::string &beta : betas)
+        {
+          fileBetas.push_back (atoi (beta.c_str ()));
+        }
+      if (fileBetas.empty ())
+        {
+          fileBetas.push_back (header.beta);
+        }
+
+      for (size_t r = 0; r < parsedRules.size (); r++)
+        {
+          std::vector<uint32_t> diffs = RecomputeDiff (records, parsedRules[r]);
+
+          // Recomputed decisions at the sender beta against the recorded ones
+          uint64_t samples = 0;
+          uint64_t agreeing = 0;
+          for (size_t i = 0; i < records.size (); i++)
+            {
+              if (IsCongestionAvoidance (records[i]))
+                {
+                  samples++;
+                  agreeing += (diffs[i] >= header.beta) == (records[i].decision != INCREASE);
+                }
+            }
+
+          for (uint32_t beta : fileBetas)
+            {
+              BetaSummary summary = Summarize (records, diffs, beta);
+              printf ("%s %s %u %llu %.2f %.3f %.2f\n", path.c_str (), rules[r].c_str (), beta,
+                      static_cast<unsigned long long> (summary.samples),
+                      summary.samples ? 100.0 * summary.fullyUtilized / summary.samples : 0.0,
+                      summary.meanDiff, samples ? 100.0 * agreeing / samples : 0.0);
+            }
+
+          if (!series.empty ())
+            {
+              std::string rule = rules[r];
+              for (char &c : rule)
+                {
+                  c = (c == ':') ? '-' : c;
+                }
+              std::string out = series + "/" + BaseName (path) + "-diff-" + rule + ".plotme";
+              if (!WriteSeries (out, records, diffs))
+                {
+                  std::cerr << "Cannot write " << out << std::endl;
+                  failed = true;
+                }
+            }
+        }
+    }
+  return failed ? 1 : 0;
+}
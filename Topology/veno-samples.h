@@ -0,0 +1,247 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Binary format of the TcpVeno sample streams written by the dumbbell
+ * topology (--venoSamples), and the offline Veno backlog estimator used by
+ * veno-replay.cc. It does not depend on ns-3.
+ *
+ * A stream is a FileHeader followed by FileHeader::records Records, in
+ * native byte order, sorted by time. Each record is one TcpVeno::Sample,
+ * i.e. one call of IncreaseWindow.
+ */
+
+#ifndef VENO_SAMPLES_H
+#define VENO_SAMPLES_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace venosamples {
+
+const char MAGIC[8] = {'V', 'E', 'N', 'O', 'S', 'M', 'P', '1'};
+const uint32_t NO_RTT = UINT32_MAX;   // minRtt without RTT sample since the last increase
+
+// How the records of a stream were selected
+enum Mode
+{
+  MODE_ALL,          // every sample
+  MODE_DOWNSAMPLE,   // one sample out of FileHeader::parameter
+  MODE_RESERVOIR     // uniform sample of FileHeader::parameter samples
+};
+
+// Same values as TcpVeno::Decision
+enum Decision
+{
+  NEWRENO,
+  SLOW_START,
+  INCREASE,
+  INCREASE_OTHER,
+  HOLD
+};
+
+struct FileHeader
+{
+  char magic[8];
+  uint32_t recordSize;
+  uint32_t mode;
+  uint32_t parameter;   // Downsampling period or reservoir size
+  uint32_t beta;        // Beta of the sender
+  uint64_t offered;     // Samples reported by the sender
+  uint64_t records;     // Records in the stream
+};
+
+struct Record
+{
+  double time;          // Seconds
+  uint32_t rttUs;       // Last RTT sample
+  uint32_t baseRttUs;   // Minimum RTT of the connection
+  uint32_t minRttUs;    // Minimum RTT since the last increase, or NO_RTT
+  uint32_t segCwnd;
+  uint32_t targetCwnd;
+  uint16_t diff;        // Saturated at UINT16_MAX
+  uint8_t decision;
+  uint8_t reserved;
+};
+
+static_assert (sizeof (FileHeader) == 40, "FileHeader must have no padding");
+static_assert (sizeof (Record) == 32, "Record must have no padding");
+
+inline bool
+IsCongestionAvoidance (const Record &record)
+{
+  return record.decision >= INCREASE;
+}
+
+// Veno's backlog estimate: 2 * (segCwnd - segCwnd * baseRtt / rtt)
+inline uint32_t
+Diff (uint32_t segCwnd, double baseRtt, double rtt)
+{
+  if (rtt <= baseRtt)
+    {
+      return 0;
+    }
+  uint32_t targetCwnd = static_cast<uint32_t> (segCwnd * (baseRtt / rtt));
+  return 2 * (segCwnd - targetCwnd);
+}
+
+// Reads a whole stream; returns false and sets error on failure
+inline bool
+ReadFile (const std::string &path, FileHeader &header, std::vector<Record> &records, std::string &error)
+{
+  FILE *file = fopen (path.c_str (), "rb");
+  if (!file)
+    {
+      error = "cannot open " + path;
+      return false;
+    }
+  bool ok = fread (&header, sizeof (header), 1, file) == 1
+    && memcmp (header.magic, MAGIC, sizeof (MAGIC)) == 0
+    && header.recordSize == sizeof (Record);
+  if (ok)
+    {
+      records.resize (header.records);
+      ok = header.records == 0 || fread (records.data (), sizeof (Record), header.records, file) == header.records;
+    }
+  fclose (file);
+  if (!ok)
+    {
+      error = path + " is not a complete Veno sample stream";
+    }
+  return ok;
+}
+
+// Rule giving the baseRtt of every record
+struct BaseRttRule
+{
+  enum Kind
+  {
+    RECORDED,   // baseRtt of the sender
+    MIN,        // minimum of the RTT samples of the stream so far
+    WINDOW,     // minimum of the RTT samples of the last value seconds
+    FIXED       // value milliseconds
+  };
+  Kind kind = RECORDED;
+  double value = 0;
+};
+
+// Parses "recorded", "min", "window:<s>" or "fixed:<ms>"
+inline bool
+ParseBaseRttRule (const std::string &text, BaseRttRule &rule)
+{
+  if (text == "recorded" || text == "min")
+    {
+      rule.kind = (text == "min") ? BaseRttRule::MIN : BaseRttRule::RECORDED;
+      return true;
+    }
+  size_t colon = text.find (':');
+  if (colon == std::string::npos)
+    {
+      return false;
+    }
+  std::string kind = text.substr (0, colon);
+  rule.value = atof (text.c_str () + colon + 1);
+  if (rule.value <= 0)
+    {
+      return false;
+    }
+  rule.kind = (kind == "window") ? BaseRttRule::WINDOW : BaseRttRule::FIXED;
+  return kind == "window" || kind == "fixed";
+}
+
+// Recomputes the diff of every record under a baseRtt rule, with the minRtt
+// of the record as the actual RTT. As in TcpVeno, a record without minRtt
+// has a target cwnd of 0. The MIN and WINDOW rules only see the RTT samples
+// kept in the stream, so they are exact with MODE_ALL and approximations
+// otherwise.
+inline std::vector<uint32_t>
+RecomputeDiff (const std::vector<Record> &records, const BaseRttRule &rule)
+{
+  std::vector<uint32_t> diffs;
+  diffs.reserve (records.size ());
+  std::deque<std::pair<double, uint32_t> > window;   // (time, rtt), increasing rtt
+  uint32_t minRtt = NO_RTT;
+  for (const Record &record : records)
+    {
+      double rtt = (record.minRttUs == NO_RTT) ? HUGE_VAL : record.minRttUs;
+      double baseRtt = record.baseRttUs;
+      if (rule.kind == BaseRttRule::MIN)
+        {
+          minRtt = std::min (minRtt, record.rttUs);
+          baseRtt = minRtt;
+        }
+      else if (rule.kind == BaseRttRule::WINDOW)
+        {
+          while (!window.empty () && window.back ().second >= record.rttUs)
+            {
+              window.pop_back ();
+            }
+          window.push_back (std::make_pair (record.time, record.rttUs));
+          while (window.front ().first < record.time - rule.value)
+            {
+              window.pop_front ();
+            }
+          baseRtt = window.front ().second;
+        }
+      else if (rule.kind == BaseRttRule::FIXED)
+        {
+          baseRtt = rule.value * 1000;
+        }
+      diffs.push_back (Diff (record.segCwnd, baseRtt, rtt));
+    }
+  return diffs;
+}
+
+// Congestion avoidance decisions of one beta
+struct BetaSummary
+{
+  uint32_t beta = 0;
+  uint64_t samples = 0;        // Records in congestion avoidance
+  uint64_t fullyUtilized = 0;  // ... of which diff >= beta (cwnd grows every other RTT)
+  double meanDiff = 0;
+};
+
+inline BetaSummary
+Summarize (const std::vector<Record> &records, const std::vector<uint32_t> &diffs, uint32_t beta)
+{
+  BetaSummary summary;
+  summary.beta = beta;
+  double sum = 0;
+  for (size_t i = 0; i < records.size (); i++)
+    {
+      if (!IsCongestionAvoidance (records[i]))
+        {
+          continue;
+        }
+      summary.samples++;
+      summary.fullyUtilized += diffs[i] >= beta;
+      sum += diffs[i];
+    }
+  summary.meanDiff = summary.samples ? sum / summary.samples : 0;
+  return summary;
+}
+
+} // namespace venosamples
+
+#endif // VENO_SAMPLES_H
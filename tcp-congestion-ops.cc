@@ -19,6 +19,10 @@
 #include "tcp-congestion-ops.h"
 #include "tcp-socket-base.h"
 #include "ns3/log.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
+#include "ns3/simulator.h"
+#include "ns3/abort.h"
 
 namespace ns3 {
 
@@ -66,6 +70,32 @@ TcpNewReno::GetTypeId (void)
     .SetParent<TcpCongestionOps> ()
     .SetGroupName ("Internet")
     .AddConstructor<TcpNewReno> ()
+    .AddAttribute ("HyStart", "Leave slow start on ACK-train or delay-increase "
+                   "detection, as Linux HyStart does",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&TcpNewReno::m_hystart),
+                   MakeBooleanChecker ())
+    .AddAttribute ("HyStartLowWindow", "Lower bound cWnd (in segments) for HyStart",
+                   UintegerValue (16),
+                   MakeUintegerAccessor (&TcpNewReno::m_hystartLowWindow),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("HyStartMinSamples", "Number of RTT samples per round "
+                   "for delay-increase detection",
+                   UintegerValue (8),
+                   MakeUintegerAccessor (&TcpNewReno::m_hystartMinSamples),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("HyStartAckDelta", "Spacing between ACKs indicating an ACK train",
+                   TimeValue (MilliSeconds (2)),
+                   MakeTimeAccessor (&TcpNewReno::m_hystartAckDelta),
+                   MakeTimeChecker ())
+    .AddAttribute ("HyStartMinDelayThresh", "Minimum delay increase that ends slow start",
+                   TimeValue (MilliSeconds (4)),
+                   MakeTimeAccessor (&TcpNewReno::m_hystartDelayMinThresh),
+                   MakeTimeChecker ())
+    .AddAttribute ("HyStartMaxDelayThresh", "Maximum delay increase that ends slow start",
+                   TimeValue (MilliSeconds (16)),
+                   MakeTimeAccessor (&TcpNewReno::m_hystartDelayMaxThresh),
+                   MakeTimeChecker ())
   ;
   return tid;
 }
@@ -76,7 +106,13 @@ TcpNewReno::TcpNewReno (void) : TcpCongestionOps ()
 }
 
 TcpNewReno::TcpNewReno (const TcpNewReno& sock)
-  : TcpCongestionOps (sock)
+  : TcpCongestionOps (sock),
+    m_hystart (sock.m_hystart),
+    m_hystartLowWindow (sock.m_hystartLowWindow),
+    m_hystartMinSamples (sock.m_hystartMinSamples),
+    m_hystartAckDelta (sock.m_hystartAckDelta),
+    m_hystartDelayMinThresh (sock.m_hystartDelayMinThresh),
+    m_hystartDelayMaxThresh (sock.m_hystartDelayMaxThresh)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -157,6 +193,119 @@ TcpNewReno::IncreaseWindow (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked)
     }
 }
 
+/* HyStart (Ha and Rhee, "Taming the elephants", 2011) as implemented in
+Linux tcp_cubic.c. Slow start is left early, by setting ssthresh to the
+current cwnd, when either the ACKs of a round arrive as a closely spaced train
+spanning half the minimum RTT, or the RTT of a round grows noticeably above
+the minimum RTT. Both are signs that the bottleneck queue is filling up.
+ */
+void
+TcpNewReno::PktsAcked (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked,
+                       const Time& rtt)
+{
+  NS_LOG_FUNCTION (this << tcb << segmentsAcked << rtt);
+
+  if (!m_hystart || rtt.IsZero ())
+    {
+      return;
+    }
+
+  // First time call or link delay decreases
+  if (m_hsDelayMin.IsZero () || m_hsDelayMin > rtt)
+    {
+      m_hsDelayMin = rtt;
+    }
+
+  if (tcb->m_cWnd < tcb->m_ssThresh)
+    {
+      // Linux starts a new round once the ACK passes the snd_nxt recorded at
+      // the last reset; one cWnd worth of acked segments marks the same point.
+      m_hsRoundAcked += segmentsAcked;
+      if (m_hsRoundAcked >= m_hsRoundSegs)
+        {
+          HyStartReset (tcb);
+        }
+
+      if (tcb->GetCwndInSegments () >= m_hystartLowWindow)
+        {
+          HyStartUpdate (tcb, rtt);
+        }
+    }
+}
+
+void
+TcpNewReno::HyStartReset (Ptr<const TcpSocketState> tcb)
+{
+  NS_LOG_FUNCTION (this << tcb);
+
+  m_hsRoundStart = m_hsLastAck = Simulator::Now ();
+  m_hsRoundSegs = tcb->GetCwndInSegments ();
+  m_hsRoundAcked = 0;
+  m_hsCurrRtt = Time (0);
+  m_hsSampleCnt = 0;
+}
+
+void
+TcpNewReno::HyStartUpdate (Ptr<TcpSocketState> tcb, const Time &rtt)
+{
+  NS_LOG_FUNCTION (this << tcb << rtt);
+
+  if (m_hsFound)
+    {
+      return;
+    }
+
+  // First detection parameter - ACK-train detection
+  Time now = Simulator::Now ();
+  if (now - m_hsLastAck <= m_hystartAckDelta)
+    {
+      m_hsLastAck = now;
+      if (now - m_hsRoundStart > m_hsDelayMin / 2)
+        {
+          m_hsFound = true;
+          tcb->m_ssThresh = tcb->m_cWnd;
+          NS_LOG_INFO ("HyStart ACK train detected, ssthresh set to " << tcb->m_ssThresh);
+          return;
+        }
+    }
+
+  // Second detection parameter - delay increase detection
+  if (m_hsSampleCnt < m_hystartMinSamples)
+    {
+      if (m_hsCurrRtt.IsZero () || m_hsCurrRtt > rtt)
+        {
+          m_hsCurrRtt = rtt;
+        }
+      m_hsSampleCnt++;
+    }
+  else
+    {
+      Time thresh = std::min (std::max (m_hsDelayMin / 8, m_hystartDelayMinThresh),
+                              m_hystartDelayMaxThresh);
+      if (m_hsCurrRtt > m_hsDelayMin + thresh)
+        {
+          m_hsFound = true;
+          tcb->m_ssThresh = tcb->m_cWnd;
+          NS_LOG_INFO ("HyStart delay increase detected, ssthresh set to " << tcb->m_ssThresh);
+        }
+    }
+}
+
+void
+TcpNewReno::CongestionStateSet (Ptr<TcpSocketState> tcb,
+                                const TcpSocketState::TcpCongState_t newState)
+{
+  NS_LOG_FUNCTION (this << tcb << newState);
+
+  // As bictcp_state in Linux: after an RTO slow start is probed again
+  if (newState == TcpSocketState::CA_LOSS)
+    {
+      m_hsFound = false;
+      m_hsDelayMin = Time (0);
+      HyStartReset (tcb);
+    }
+}
+
 std::string
 TcpNewReno::GetName () const
 {
@@ -173,6 +322,35 @@ TcpNewReno::GetSsThresh (Ptr<const TcpSocketState> state,
   return std::max<uint32_t> (2 * state->m_segmentSize, state->m_cWnd / 2);
 }
 
+void
+TcpNewReno::SerializeState (std::ostream &os) const
+{
+  NS_LOG_FUNCTION (this);
+
+  // Round start and last ACK are stored as ages, the clock of the run
+  // restoring the state being different
+  Time now = Simulator::Now ();
+  os << m_cWndCntInPacket << " " << m_hsFound << " "
+     << (now - m_hsRoundStart).GetTimeStep () << " " << (now - m_hsLastAck).GetTimeStep () << " "
+     << m_hsDelayMin.GetTimeStep () << " " << m_hsCurrRtt.GetTimeStep () << " "
+     << m_hsSampleCnt << " " << m_hsRoundSegs << " " << m_hsRoundAcked << " ";
+}
+
+void
+TcpNewReno::DeserializeState (std::istream &is)
+{
+  NS_LOG_FUNCTION (this);
+
+  int64_t roundAge, lastAckAge, delayMin, currRtt;
+  is >> m_cWndCntInPacket >> m_hsFound >> roundAge >> lastAckAge >> delayMin >> currRtt
+     >> m_hsSampleCnt >> m_hsRoundSegs >> m_hsRoundAcked;
+  NS_ABORT_MSG_IF (is.fail (), "Malformed TcpNewReno state");
+  m_hsRoundStart = Simulator::Now () - Time (roundAge);
+  m_hsLastAck = Simulator::Now () - Time (lastAckAge);
+  m_hsDelayMin = Time (delayMin);
+  m_hsCurrRtt = Time (currRtt);
+}
+
 Ptr<TcpCongestionOps>
 TcpNewReno::Fork ()
 {
@@ -154,6 +154,33 @@ public:
     NS_UNUSED (tcb);
     NS_UNUSED (event);
   }
+  /**
+   * \brief Write the internal state of the algorithm
+   *
+   * Used to checkpoint a connection so that a later simulation can start
+   * from the same congestion control state instead of from scratch. Only the
+   * variables that evolve during the connection are written; attributes are
+   * configured as usual. Points in time are written relative to the time
+   * of the checkpoint, as the later simulation has its own clock. The
+   * default implementation writes nothing.
+   *
+   * \param os stream to write to
+   */
+  virtual void SerializeState (std::ostream &os) const
+  {
+    NS_UNUSED (os);
+  }
+
+  /**
+   * \brief Read back the internal state written by SerializeState
+   *
+   * \param is stream to read from
+   */
+  virtual void DeserializeState (std::istream &is)
+  {
+    NS_UNUSED (is);
+  }
+
   // Present in Linux but not in ns-3 yet:
   /* call when ack arrives (optional) */
   // void (*in_ack_event)(struct sock *sk, u32 flags);
@@ -202,15 +229,75 @@ public:
   virtual uint32_t GetSsThresh (Ptr<const TcpSocketState> tcb,
                                 uint32_t bytesInFlight);
 
+  /**
+   * \brief Collect the RTT samples used by HyStart
+   *
+   * Does nothing unless the HyStart attribute is enabled.
+   *
+   * \param tcb internal congestion state
+   * \param segmentsAcked count of segments acked
+   * \param rtt last rtt
+   */
+  virtual void PktsAcked (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked,
+                          const Time& rtt);
+
+  /**
+   * \brief Re-arm HyStart when the connection enters the loss state
+   *
+   * \param tcb internal congestion state
+   * \param newState new congestion state to which the TCP is going to switch
+   */
+  virtual void CongestionStateSet (Ptr<TcpSocketState> tcb,
+                                   const TcpSocketState::TcpCongState_t newState);
+
+  virtual void SerializeState (std::ostream &os) const;
+  virtual void DeserializeState (std::istream &is);
+
   virtual Ptr<TcpCongestionOps> Fork ();
 
 protected:
   virtual uint32_t SlowStart (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked);
   virtual void CongestionAvoidance (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked);
 
+  /**
+   * \brief Start a new HyStart round
+   *
+   * Mimics bictcp_hystart_reset in Linux.
+   *
+   * \param tcb internal congestion state
+   */
+  void HyStartReset (Ptr<const TcpSocketState> tcb);
+
+  /**
+   * \brief Run the ACK-train and delay-increase slow start exit checks
+   *
+   * Mimics hystart_update in Linux: when either check fires, ssThresh is
+   * set to the current cWnd so that the next ACK moves the connection into
+   * congestion avoidance.
+   *
+   * \param tcb internal congestion state
+   * \param rtt last rtt
+   */
+  void HyStartUpdate (Ptr<TcpSocketState> tcb, const Time &rtt);
+
 private:
   uint32_t m_cWndCntInPacket {0}; /* CHANGED --Linear increase counter in terms of packets.*/
 
+  bool m_hystart {false};              //!< Enable HyStart slow start exit
+  uint32_t m_hystartLowWindow {16};    //!< cWnd (in segments) below which HyStart is inactive
+  uint32_t m_hystartMinSamples {8};    //!< RTT samples per round for delay-increase detection
+  Time m_hystartAckDelta;              //!< Maximum spacing of ACKs belonging to one ACK train
+  Time m_hystartDelayMinThresh;        //!< Lower clamp of the delay-increase threshold
+  Time m_hystartDelayMaxThresh;        //!< Upper clamp of the delay-increase threshold
+
+  bool m_hsFound {false};              //!< Slow start exit point already found
+  Time m_hsRoundStart;                 //!< Beginning of the current round
+  Time m_hsLastAck;                    //!< Last ACK time of the current ACK train
+  Time m_hsDelayMin;                   //!< Minimum RTT seen since the last reset
+  Time m_hsCurrRtt;                    //!< Minimum RTT of the samples taken in this round
+  uint32_t m_hsSampleCnt {0};          //!< RTT samples taken in this round
+  uint32_t m_hsRoundSegs {0};          //!< cWnd (in segments) when the round started
+  uint32_t m_hsRoundAcked {0};         //!< Segments acked since the round started
 };
 
 } // namespace ns3
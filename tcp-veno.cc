@@ -26,6 +26,11 @@
 
 #include "tcp-veno.h"
 #include "ns3/log.h"
+#include "ns3/enum.h"
+#include "ns3/double.h"
+#include "ns3/uinteger.h"
+#include "ns3/abort.h"
+#include "ns3/boolean.h"
 
 namespace ns3 {
 
@@ -43,6 +48,35 @@ TcpVeno::GetTypeId (void)
                    UintegerValue (3),
                    MakeUintegerAccessor (&TcpVeno::m_beta),
                    MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("LossClassifier", "Rule deciding whether a loss is random or congestive",
+                   EnumValue (TcpVeno::DIFF),
+                   MakeEnumAccessor (&TcpVeno::m_classifier),
+                   MakeEnumChecker (TcpVeno::DIFF, "Diff",
+                                    TcpVeno::RTT_DISTRIBUTION, "RttDistribution"))
+    .AddAttribute ("RttQuantile", "RTT quantile used by the RttDistribution classifier",
+                   DoubleValue (0.5),
+                   MakeDoubleAccessor (&TcpVeno::m_rttQuantile),
+                   MakeDoubleChecker<double> (0.0, 1.0))
+    .AddAttribute ("RttBinWidth", "Width of an RTT histogram bin, as a fraction of BaseRTT",
+                   DoubleValue (0.05),
+                   MakeDoubleAccessor (&TcpVeno::m_rttBinWidth),
+                   MakeDoubleChecker<double> (0.001))
+    .AddAttribute ("RttWindow", "Number of recent RTT samples used by the RttDistribution classifier",
+                   UintegerValue (32),
+                   MakeUintegerAccessor (&TcpVeno::m_rttWindow),
+                   MakeUintegerChecker<uint32_t> (1, RTT_WINDOW_MAX))
+    .AddAttribute ("Pacing", "Pace the segments at PacingGain * cwnd / minRtt",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&TcpVeno::m_pacing),
+                   MakeBooleanChecker ())
+    .AddAttribute ("PacingGain", "Ratio of the pacing rate to cwnd / minRtt",
+                   DoubleValue (1.2),
+                   MakeDoubleAccessor (&TcpVeno::m_pacingGain),
+                   MakeDoubleChecker<double> (0.1))
+    .AddTraceSource ("Sample",
+                     "RTT samples, backlog estimate and decision of each window increase",
+                     MakeTraceSourceAccessor (&TcpVeno::m_sampleTrace),
+                     "ns3::TcpVeno::SampleTracedCallback")
   ;
   return tid;
 }
@@ -56,9 +90,20 @@ TcpVeno::TcpVeno (void)
     m_diff (0),
     m_inc (true),
     m_ackCnt (0),
-    m_beta (6)
+    m_beta (6),
+    m_ceMarked (false),
+    m_classifier (DIFF),
+    m_rttQuantile (0.5),
+    m_rttBinWidth (0.05),
+    m_rttWindow (32),
+    m_rttHead (0),
+    m_rttCount (0),
+    m_pacing (false),
+    m_pacingGain (1.2),
+    m_lastRtt (Time (0))
 {
   NS_LOG_FUNCTION (this);
+  m_rttHist.fill (0);
 }
 
 TcpVeno::TcpVeno (const TcpVeno& sock)
@@ -70,9 +115,20 @@ TcpVeno::TcpVeno (const TcpVeno& sock)
     m_diff (0),
     m_inc (true),
     m_ackCnt (sock.m_ackCnt),
-    m_beta (sock.m_beta)
+    m_beta (sock.m_beta),
+    m_ceMarked (false),
+    m_classifier (sock.m_classifier),
+    m_rttQuantile (sock.m_rttQuantile),
+    m_rttBinWidth (sock.m_rttBinWidth),
+    m_rttWindow (sock.m_rttWindow),
+    m_rttHead (0),
+    m_rttCount (0),
+    m_pacing (sock.m_pacing),
+    m_pacingGain (sock.m_pacingGain),
+    m_lastRtt (sock.m_lastRtt)
 {
   NS_LOG_FUNCTION (this);
+  m_rttHist.fill (0);
 }
 
 TcpVeno::~TcpVeno (void)
@@ -92,11 +148,14 @@ TcpVeno::PktsAcked (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked,
 {
   NS_LOG_FUNCTION (this << tcb << segmentsAcked << rtt);
 
+  TcpNewReno::PktsAcked (tcb, segmentsAcked, rtt);
+
   if (rtt.IsZero ())
     {
       return;
     }
   
+  m_lastRtt = rtt;
   m_baseRtt = std::min (m_baseRtt, rtt);
   NS_LOG_DEBUG ("Updated m_baseRtt= " << m_baseRtt);
   m_minRtt = std::min (m_minRtt, rtt);
@@ -106,6 +165,84 @@ TcpVeno::PktsAcked (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked,
   // Update RTT counter
   m_cntRtt++;
   NS_LOG_DEBUG ("Updated m_cntRtt= " << m_cntRtt);
+
+  if (m_classifier == RTT_DISTRIBUTION)
+    {
+      AddRttSample (rtt);
+    }
+
+  if (m_pacing)
+    {
+      UpdatePacingRate (tcb);
+    }
+}
+
+void
+TcpVeno::UpdatePacingRate (Ptr<TcpSocketState> tcb) const
+{
+  NS_LOG_FUNCTION (this << tcb);
+
+  // m_minRtt is the minimum RTT since the last window increase
+  double rate = m_pacingGain * tcb->m_cWnd * 8.0 / m_minRtt.GetSeconds ();
+  if (tcb->m_maxPacingRate.GetBitRate () > 0)
+    {
+      rate = std::min<double> (rate, tcb->m_maxPacingRate.GetBitRate ());
+    }
+  tcb->m_pacing = true;
+  tcb->m_currentPacingRate = DataRate (static_cast<uint64_t> (rate));
+  NS_LOG_DEBUG ("Pacing at " << tcb->m_currentPacingRate);
+}
+
+void
+TcpVeno::AddRttSample (const Time &rtt)
+{
+  NS_LOG_FUNCTION (this << rtt);
+
+  double excess = (rtt.GetSeconds () / m_baseRtt.GetSeconds () - 1.0) / m_rttBinWidth;
+  uint8_t bin = static_cast<uint8_t> (std::min<double> (excess, RTT_BINS - 1));
+
+  if (m_rttCount < m_rttWindow)
+    {
+      m_rttSamples[m_rttCount++] = bin;
+    }
+  else
+    {
+      // Window is full, the newest sample replaces the oldest one
+      m_rttHist[m_rttSamples[m_rttHead]]--;
+      m_rttSamples[m_rttHead] = bin;
+      m_rttHead = (m_rttHead + 1) % m_rttCount;
+    }
+  m_rttHist[bin]++;
+  NS_LOG_DEBUG ("RTT sample in bin " << static_cast<uint32_t> (bin) << ", " << m_rttCount << " samples");
+}
+
+bool
+TcpVeno::IsCongestiveLoss (Ptr<const TcpSocketState> tcb) const
+{
+  NS_LOG_FUNCTION (this << tcb);
+
+  if (m_classifier == DIFF || m_rttCount == 0)
+    {
+      return m_diff >= m_beta;
+    }
+
+  // Find the bin holding the requested quantile of the recent RTT samples
+  uint32_t rank = static_cast<uint32_t> (m_rttQuantile * (m_rttCount - 1));
+  uint32_t bin = 0;
+  uint32_t seen = m_rttHist[0];
+  while (seen <= rank && bin < RTT_BINS - 1)
+    {
+      seen += m_rttHist[++bin];
+    }
+
+  // Same backlog estimate as IncreaseWindow, with the quantile RTT (taken at
+  // the middle of its bin) in place of minRtt
+  uint32_t segCwnd = tcb->GetCwndInSegments ();
+  double ratio = 1.0 + (bin + 0.5) * m_rttBinWidth;
+  uint32_t targetCwnd = static_cast<uint32_t> (segCwnd / ratio);
+  uint32_t diff = 2 * (segCwnd - targetCwnd);
+  NS_LOG_DEBUG ("RTT quantile " << m_rttQuantile << " at " << ratio << " x baseRtt, diff " << diff);
+  return diff >= m_beta;
 }
 
 void
@@ -130,8 +267,15 @@ TcpVeno::CongestionStateSet (Ptr<TcpSocketState> tcb,
                              const TcpSocketState::TcpCongState_t newState)
 {
   NS_LOG_FUNCTION (this << tcb << newState);
+  TcpNewReno::CongestionStateSet (tcb, newState);
+  if (newState == TcpSocketState::CA_CWR)
+    {
+      // CWR is only entered on reception of an ECN-Echo
+      m_ceMarked = true;
+    }
   if (newState == TcpSocketState::CA_OPEN)
     {
+      m_ceMarked = false;
       EnableVeno ();
       NS_LOG_LOGIC ("Veno is now on.");
     }
@@ -169,11 +313,21 @@ TcpVeno::IncreaseWindow (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked)
   m_diff = 2*(segCwnd - targetCwnd);             /*CHANGED -- According to linux code(because 1 bit left shift used) calculation of m_diff    involves multiplication with 2*/
   NS_LOG_DEBUG ("Calculated m_diff = " << m_diff);
 
+  Sample sample;
+  sample.rtt = m_lastRtt;
+  sample.baseRtt = m_baseRtt;
+  sample.minRtt = m_minRtt;
+  sample.segCwnd = segCwnd;
+  sample.targetCwnd = targetCwnd;
+  sample.diff = m_diff;
+  sample.decision = NEWRENO;
+
   if (!m_doingVenoNow)
     {
       // If Veno is not on, we follow NewReno algorithm
       NS_LOG_LOGIC ("Veno is not turned on, we follow NewReno algorithm.");
       TcpNewReno::IncreaseWindow (tcb, segmentsAcked);
+      m_sampleTrace (sample);
       return;
     }
 
@@ -191,6 +345,7 @@ TcpVeno::IncreaseWindow (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked)
         { // Slow start mode. Veno employs same slow start algorithm as NewReno's.
           NS_LOG_LOGIC ("We are in slow start, behave like NewReno.");
           TcpNewReno::SlowStart (tcb, segmentsAcked);
+          sample.decision = SLOW_START;
         }
 
       else
@@ -205,6 +360,7 @@ TcpVeno::IncreaseWindow (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked)
               NS_LOG_LOGIC ("Available bandwidth not fully utilized, increase "
                             "cwnd by 1 every RTT");
               TcpNewReno::CongestionAvoidance (tcb,segmentsAcked);
+              sample.decision = INCREASE;
             }
           else
             {
@@ -216,14 +372,17 @@ TcpVeno::IncreaseWindow (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked)
                 {
                   TcpNewReno::CongestionAvoidance (tcb,segmentsAcked);
                   m_inc = false;
+                  sample.decision = INCREASE_OTHER;
                 }
               else
                 {
                   m_inc = true;
+                  sample.decision = HOLD;
                 }
             }
         }
     }
+  m_sampleTrace (sample);
 
   // Reset minRtt every RTT
 
@@ -231,6 +390,67 @@ TcpVeno::IncreaseWindow (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked)
   m_minRtt = Time::Max ();
 }
 
+void
+TcpVeno::CwndEvent (Ptr<TcpSocketState> tcb,
+                    const TcpSocketState::TcpCAEvent_t event)
+{
+  NS_LOG_FUNCTION (this << tcb << event);
+
+  // CA_EVENT_ECN_IS_CE is only raised on the data receiver; the sender
+  // learns about the mark from the ECN-Echo, see CongestionStateSet
+  if (event == TcpSocketState::CA_EVENT_COMPLETE_CWR)
+    {
+      NS_LOG_LOGIC ("CWR reduction complete");
+      m_ceMarked = false;
+    }
+}
+
+void
+TcpVeno::SerializeState (std::ostream &os) const
+{
+  NS_LOG_FUNCTION (this);
+
+  TcpNewReno::SerializeState (os);
+  os << m_baseRtt.GetTimeStep () << " " << m_minRtt.GetTimeStep () << " "
+     << m_cntRtt << " " << m_doingVenoNow << " " << m_diff << " " << m_inc << " "
+     << m_ackCnt << " " << m_ceMarked << " " << m_rttHead << " " << m_rttCount;
+  for (uint32_t i = 0; i < m_rttCount; i++)
+    {
+      os << " " << static_cast<uint32_t> (m_rttSamples[i]);
+    }
+  os << " ";
+}
+
+void
+TcpVeno::DeserializeState (std::istream &is)
+{
+  NS_LOG_FUNCTION (this);
+
+  TcpNewReno::DeserializeState (is);
+  int64_t baseRtt, minRtt;
+  is >> baseRtt >> minRtt >> m_cntRtt >> m_doingVenoNow >> m_diff >> m_inc
+     >> m_ackCnt >> m_ceMarked >> m_rttHead >> m_rttCount;
+  NS_ABORT_MSG_IF (is.fail (), "Malformed TcpVeno state");
+  // AddRttSample replaces the sample at m_rttHead once m_rttWindow samples
+  // are kept, so both must fit the configured window
+  NS_ABORT_MSG_UNLESS (m_rttCount <= m_rttWindow && m_rttHead < std::max (m_rttCount, 1u),
+                       "TcpVeno state with " << m_rttCount << " RTT samples (head " << m_rttHead
+                       << ") does not fit RttWindow " << m_rttWindow);
+  m_baseRtt = Time (baseRtt);
+  m_minRtt = Time (minRtt);
+
+  // The histogram is rebuilt from the samples
+  m_rttHist.fill (0);
+  for (uint32_t i = 0; i < m_rttCount; i++)
+    {
+      uint32_t bin;
+      is >> bin;
+      NS_ABORT_MSG_IF (is.fail () || bin >= RTT_BINS, "Malformed TcpVeno RTT sample");
+      m_rttSamples[i] = static_cast<uint8_t> (bin);
+      m_rttHist[bin]++;
+    }
+}
+
 std::string
 TcpVeno::GetName () const
 {
@@ -243,7 +463,17 @@ TcpVeno::GetSsThresh (Ptr<const TcpSocketState> tcb,
 {
   NS_LOG_FUNCTION (this << tcb << bytesInFlight);
 
-  if (m_diff < m_beta)
+  // The ECN state is already ECE_RCVD when the reduction for an ECN-Echo is
+  // computed, before CongestionStateSet (CA_CWR) is called
+  if (m_ceMarked || tcb->m_ecnState == TcpSocketState::ECN_ECE_RCVD)
+    {
+      // The bottleneck marked a packet, so congestion is certain:
+      // we reduce cwnd by 1/2 as in NewReno
+      NS_LOG_LOGIC ("ECN congestion signal, cwnd is halved");
+      return std::max <uint32_t> (tcb->m_cWnd / 2, 2 * tcb->m_segmentSize);
+    }
+
+  if (!IsCongestiveLoss (tcb))
     {
       // random loss due to bit errors is most likely to have occurred,
       // we cut cwnd by 1/5